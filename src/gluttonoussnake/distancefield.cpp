@@ -0,0 +1,93 @@
+﻿#include "distancefield.h"
+#include <cassert>
+#include <climits>
+#include <algorithm>
+
+DistanceField::DistanceField()
+{
+}
+
+DistanceField::~DistanceField()
+{
+}
+
+bool DistanceField::Search(
+    const GameMap& map,
+    const ashes::Coord& src,
+    const ashes::Coord* dest)
+{
+    assert(map.NumGrids() > 0);
+    assert(map.ValidateCoord(src));
+    assert(dest == nullptr || map.ValidateCoord(*dest));
+
+    Prepare(map.NumIndices());
+
+    // grids beyond the map are walls, which are never pushed, so adjacencies
+    // of pushed grids are always in the bordered map.
+    const int offsets[] = {
+        map.AdjacencyOffset(ashes::Direction4::Leftward),
+        map.AdjacencyOffset(ashes::Direction4::Forward),
+        map.AdjacencyOffset(ashes::Direction4::Rightward),
+        map.AdjacencyOffset(ashes::Direction4::Backward)};
+    const int dest_index = (dest != nullptr ? map.CoordToIndex(*dest) : -1);
+    const int src_index = map.CoordToIndex(src);
+
+    int queue_front = 0;
+    int queue_back = 0;
+    stamps_[src_index] = {generation_, 0};
+    open_queue_[queue_back++] = src_index;
+
+    while (queue_front < queue_back)
+    {
+        const int cur_index = open_queue_[queue_front++];
+        const int next_dist = stamps_[cur_index].dist + 1;
+
+        for (int offset : offsets)
+        {
+            const int next_index = cur_index + offset;
+            Stamp& next_stamp = stamps_[next_index];
+            if (next_stamp.generation == generation_)
+                continue;
+
+            if (next_index == dest_index)
+            {
+                next_stamp = {generation_, next_dist};
+                return true;
+            }
+
+            if (map.GetGridType(next_index) == GameMap::GridType::Space)
+            {
+                next_stamp = {generation_, next_dist};
+                open_queue_[queue_back++] = next_index;
+            }
+        }
+    }
+
+    return dest == nullptr;
+}
+
+int DistanceField::GetDist(int index) const
+{
+    assert(generation_ != 0);
+    assert(0 <= index && index < static_cast<int>(stamps_.size()));
+    const Stamp& stamp = stamps_[index];
+    return stamp.generation == generation_ ? stamp.dist : INT_MAX;
+}
+
+void DistanceField::Prepare(int num_indices)
+{
+    // buffers are only reallocated when the map is resized.
+    if (static_cast<int>(stamps_.size()) != num_indices)
+    {
+        stamps_.assign(num_indices, Stamp());
+        open_queue_.resize(num_indices);
+        generation_ = 0;
+    }
+
+    // stamps of a wrapped generation could be taken as new, clear them.
+    if (++generation_ == 0)
+    {
+        std::fill(stamps_.begin(), stamps_.end(), Stamp());
+        generation_ = 1;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+﻿#ifndef GLUTTONOUSSNAKE_DISTANCEFIELD_H
+#define GLUTTONOUSSNAKE_DISTANCEFIELD_H
+
+#include <vector>
+#include <cstdint>
+#include "ashes/coord.h"
+#include "gamemap.h"
+
+//==============================================================================
+// DistanceField: distances of grids from a source grid by breadth first search
+// over grid indices of a game map. distances are stamped with the generation of
+// their search, a new search bumps the generation instead of clearing them, and
+// the open queue is kept between searches.
+//==============================================================================
+
+class DistanceField
+{
+public:
+
+    DistanceField();
+    DistanceField(const DistanceField&) = delete;
+    ~DistanceField();
+    DistanceField& operator = (const DistanceField&) = delete;
+
+    // search through spaces from src until dest is reached, or until all
+    // grids reachable are if dest is null. returns false if dest isn't reached.
+    bool Search(const GameMap& map, const ashes::Coord& src, const ashes::Coord* dest);
+
+    // distance of a grid index in the last searched map, INT_MAX if unreached.
+    int GetDist(int index) const;
+
+private:
+
+    struct Stamp
+    {
+        std::uint32_t generation = 0;
+        int           dist = 0;
+    };
+
+    void Prepare(int num_indices);
+
+    std::vector<Stamp> stamps_;      // indexed by grid index.
+    std::vector<int>   open_queue_;  // each grid is pushed at most once.
+    std::uint32_t      generation_ = 0;
+};
+
+#endif
\ No newline at end of file
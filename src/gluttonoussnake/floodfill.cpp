@@ -0,0 +1,90 @@
+﻿#include "floodfill.h"
+#include <cassert>
+#include <climits>
+#include <algorithm>
+
+FloodFill::FloodFill()
+{
+}
+
+FloodFill::~FloodFill()
+{
+}
+
+int FloodFill::Distance(
+    const GameMap& map,
+    const ashes::Coord& src,
+    const ashes::Coord& dest)
+{
+    assert(map.ValidateCoord(src));
+    assert(map.ValidateCoord(dest));
+    assert(src != dest);
+
+    const int num_rows = map.Size().Y;
+    const int num_words = map.NumRowWords();
+    visited_.assign(num_rows * num_words, 0);
+    frontier_.assign(num_rows * num_words, 0);
+    next_frontier_.assign(num_rows * num_words, 0);
+
+    const int src_word = src.Y * num_words + src.X / 64;
+    const int dest_word = dest.Y * num_words + dest.X / 64;
+    const std::uint64_t src_bit = std::uint64_t(1) << (src.X % 64);
+    const std::uint64_t dest_bit = std::uint64_t(1) << (dest.X % 64);
+    frontier_[src_word] = src_bit;
+    visited_[src_word] = src_bit;
+
+    // rows of the frontier are [first_row, last_row], a layer grows one row
+    // upward and downward at most.
+    int first_row = src.Y;
+    int last_row = src.Y;
+
+    for (int dist = 1; first_row <= last_row; ++dist)
+    {
+        const int grow_first_row = (std::max)(first_row - 1, 0);
+        const int grow_last_row = (std::min)(last_row + 1, num_rows - 1);
+        int next_first_row = num_rows;
+        int next_last_row = -1;
+
+        for (int y = grow_first_row; y <= grow_last_row; ++y)
+        {
+            const std::uint64_t* row = &frontier_[y * num_words];
+            const std::uint64_t* upper_row = (y > 0 ? row - num_words : nullptr);
+            const std::uint64_t* lower_row = (y + 1 < num_rows ? row + num_words : nullptr);
+            const std::uint64_t* spaces = map.GetSpaceRow(y);
+            std::uint64_t* visited = &visited_[y * num_words];
+            std::uint64_t* next_row = &next_frontier_[y * num_words];
+            std::uint64_t row_bits = 0;
+
+            for (int i = 0; i < num_words; ++i)
+            {
+                std::uint64_t grown = row[i] << 1 | row[i] >> 1;
+                if (i > 0) { grown |= row[i - 1] >> 63; }
+                if (i + 1 < num_words) { grown |= row[i + 1] << 63; }
+                if (upper_row != nullptr) { grown |= upper_row[i]; }
+                if (lower_row != nullptr) { grown |= lower_row[i]; }
+
+                if (y * num_words + i == dest_word && (grown & dest_bit) != 0)
+                    return dist;
+
+                next_row[i] = grown & spaces[i] & ~visited[i];
+                visited[i] |= next_row[i];
+                row_bits |= next_row[i];
+            }
+
+            if (row_bits != 0)
+            {
+                next_first_row = (std::min)(next_first_row, y);
+                next_last_row = y;
+            }
+        }
+
+        // clear the layer, which is the buffer of the next layer then.
+        std::fill(frontier_.begin() + first_row * num_words,
+                  frontier_.begin() + (last_row + 1) * num_words, 0);
+        frontier_.swap(next_frontier_);
+        first_row = next_first_row;
+        last_row = next_last_row;
+    }
+
+    return INT_MAX;
+}
\ No newline at end of file
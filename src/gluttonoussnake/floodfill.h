@@ -0,0 +1,36 @@
+﻿#ifndef GLUTTONOUSSNAKE_FLOODFILL_H
+#define GLUTTONOUSSNAKE_FLOODFILL_H
+
+#include <vector>
+#include <cstdint>
+#include "ashes/coord.h"
+#include "gamemap.h"
+
+//==============================================================================
+// FloodFill: bit parallel breadth first search on the space rows of a game map.
+// a layer of grids is grown from the last one by shifting row words, 64 grids
+// a time, over the rows which the last layer covers only. it is for distances
+// and reachability, when the path itself isn't needed.
+//==============================================================================
+
+class FloodFill
+{
+public:
+
+    FloodFill();
+    FloodFill(const FloodFill&) = delete;
+    ~FloodFill();
+    FloodFill& operator = (const FloodFill&) = delete;
+
+    // distance from src to dest through spaces, INT_MAX if dest isn't reached.
+    // it is the same as the one a DistanceField search gives.
+    int Distance(const GameMap& map, const ashes::Coord& src, const ashes::Coord& dest);
+
+private:
+
+    std::vector<std::uint64_t> visited_;   // rows of bits, as the map's spaces.
+    std::vector<std::uint64_t> frontier_;  // clear beyond the rows it covers.
+    std::vector<std::uint64_t> next_frontier_;
+};
+
+#endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿#include "gameai.h"
-#include <queue>
+#include <cassert>
+#include <climits>
 
 //==============================================================================
 // Navigation
@@ -7,75 +8,28 @@
 
 namespace navigation {
 
-bool BreadthFirstSearch(
-    const GameMap& map,
-    const ashes::Coord& src,
-    const ashes::Coord* dest,
-    std::vector<int>& dists)
-{
-    assert(map.NumGrids() > 0);
-    assert(map.ValidateCoord(src));
-
-    dists.assign(map.NumGrids(), INT_MAX);
-    dists[map.CoordToIndex(src)] = 0;
-    std::queue<ashes::Coord> open_queue;
-    open_queue.push(src);
-    
-    while (!open_queue.empty())
-    {
-        const ashes::Coord cur_coord = open_queue.front();
-        const int cur_dist = dists[map.CoordToIndex(cur_coord)];
-        open_queue.pop();
-
-        for (ashes::Direction4 dir : ashes::direction4::kFullSet)
-        {
-            ashes::Coord next_coord = cur_coord.Adjacency(dir);
-            if (!map.ValidateCoord(next_coord))
-                continue;
-            
-            int& next_dist = dists[map.CoordToIndex(next_coord)];
-            if (next_dist != INT_MAX)
-                continue;
-
-            if (dest != nullptr && next_coord == *dest)
-            {
-                next_dist = cur_dist + 1;
-                return true;
-            }
-
-            if (map.GetGridType(next_coord) == GameMap::GridType::Space)
-            {
-                next_dist = cur_dist + 1;
-                open_queue.push(next_coord);
-            }
-        }
-    }
-    
-    return dest == nullptr;
-}
-
 bool BuildShortestPath(
     const GameMap& map,
     const ashes::Coord& src,
     const ashes::Coord& dest,
-    const std::vector<int>& dists_to_dest,
+    const DistanceField& dists_to_dest,
     ashes::Direction4 preferred_dir,
     std::vector<ashes::Direction4>& dir_path,
     std::vector<ashes::Coord>& coord_path)
 {
     assert(map.NumGrids() > 0);
-    assert(map.NumGrids() == static_cast<int>(dists_to_dest.size()));
     assert(map.ValidateCoord(src));
     assert(map.ValidateCoord(dest));
-    assert(dists_to_dest[map.CoordToIndex(dest)] == 0);
-    assert(dists_to_dest[map.CoordToIndex(src)] < map.NumGrids());
+    assert(dists_to_dest.GetDist(map.CoordToIndex(dest)) == 0);
+    assert(dists_to_dest.GetDist(map.CoordToIndex(src)) < map.NumGrids());
 
     dir_path.clear();
     coord_path.clear();
-    
-    for (ashes::Coord cur_coord = src; cur_coord != dest;)
+
+    const int dest_index = map.CoordToIndex(dest);
+    for (int cur_index = map.CoordToIndex(src); cur_index != dest_index;)
     {
-        const int cur_dist = dists_to_dest[map.CoordToIndex(cur_coord)];
+        const int cur_dist = dists_to_dest.GetDist(cur_index);
         const std::size_t cur_path_length = dir_path.size();
 
         const ashes::Direction4 dirs[] = {preferred_dir,
@@ -85,15 +39,14 @@ bool BuildShortestPath(
 
         for (ashes::Direction4 dir : dirs)
         {
-            ashes::Coord next_coord = cur_coord.Adjacency(dir);
+            const int next_index = cur_index + map.AdjacencyOffset(dir);
 
-            if (map.ValidateCoord(next_coord) &&
-                dists_to_dest[map.CoordToIndex(next_coord)] == cur_dist - 1)
+            if (dists_to_dest.GetDist(next_index) == cur_dist - 1)
             {
                 dir_path.push_back(dir);
-                coord_path.push_back(cur_coord);
+                coord_path.push_back(map.IndexToCoord(cur_index));
                 preferred_dir = dir;
-                cur_coord = next_coord;
+                cur_index = next_index;
                 break;
             }
         }
@@ -107,14 +60,15 @@ bool BuildShortestPath(
 }
 
 bool BuildLongestPath(
-    GameMap& map,
+    GameMirror& mirror,
     const ashes::Coord& src,
     const ashes::Coord& dest,
-    const std::vector<int>& dists_to_dest,
+    const DistanceField& dists_to_dest,
     ashes::Direction4 preferred_dir,
     std::vector<ashes::Direction4>& dir_path,
     std::vector<ashes::Coord>& coord_path)
 {
+    const GameMap& map = mirror.GetGameMap();
     if (!BuildShortestPath(map, src, dest, dists_to_dest, preferred_dir,
             dir_path, coord_path))
         return false;
@@ -122,7 +76,7 @@ bool BuildLongestPath(
     for (std::size_t i = 1; i + 1 < coord_path.size(); ++i)
     {
         assert(map.GetGridType(coord_path[i]) == GameMap::GridType::Space);
-        map.SetGridType(coord_path[i], GameMap::GridType::Snake);
+        mirror.SetGridType(coord_path[i], GameMap::GridType::Snake);
     }
 
     for (std::size_t i = 0; i + 1 < coord_path.size();)
@@ -150,8 +104,8 @@ bool BuildLongestPath(
                 dir_path.insert(dir_path.begin() + i + 2, new_dir2);
                 coord_path.insert(coord_path.begin() + i + 1, new_coord1);
                 coord_path.insert(coord_path.begin() + i + 2, new_coord2);
-                map.SetGridType(new_coord1, GameMap::GridType::Snake);
-                map.SetGridType(new_coord2, GameMap::GridType::Snake);
+                mirror.SetGridType(new_coord1, GameMap::GridType::Snake);
+                mirror.SetGridType(new_coord2, GameMap::GridType::Snake);
                 break;
             }
         }
@@ -163,26 +117,14 @@ bool BuildLongestPath(
 }
 
 void MoveSnakeAlongPath(
-    GameMap& map,
-    Snake& snake,
+    GameMirror& mirror,
     const std::vector<ashes::Direction4>& dir_path,
     bool grow_at_dest)
 {
-    for (int i = 0; i < snake.Length(); ++i)
-    {
-        map.SetGridType(snake.Node(i).pos, GameMap::GridType::Space);
-    }
-
     for (std::size_t i = 0; i < dir_path.size(); ++i)
     {
         bool grow = (i + 1 == dir_path.size() && grow_at_dest);
-        snake.SetForwardDirection(dir_path[i]);
-        grow ? snake.GrowForward() : snake.MoveForward();
-    }
-
-    for (int i = 0; i < snake.Length(); ++i)
-    {
-        map.SetGridType(snake.Node(i).pos, GameMap::GridType::Snake);
+        mirror.MoveSnake(dir_path[i], grow);
     }
 }
 
@@ -205,12 +147,13 @@ ashes::Direction4 GameAI::MakeStrategy(const GameCore& game)
 {
     std::pair<bool, ashes::Direction4> optional_dir;
 
-    CopyGameData(game);
+    mirror_.Sync(game);
     optional_dir = FindSafelyPathToFood();
+    mirror_.Undo();
     if (!optional_dir.first)
     {
-        CopyGameData(game);
         optional_dir = FindPathToTail();
+        mirror_.Undo();
         if (!optional_dir.first)
         {
             optional_dir.second = game.GetSnake().Head().dir;
@@ -220,27 +163,28 @@ ashes::Direction4 GameAI::MakeStrategy(const GameCore& game)
     return optional_dir.second;
 }
 
-void GameAI::CopyGameData(const GameCore& game)
+void GameAI::OnSnakeMoved(const GameCore::SnakeMoveEvent& event)
 {
-    game_map_ = game.GetGameMap();
-    snake_ = game.GetSnake();
-    food_ = game.GetFood();
+    mirror_.OnSnakeMoved(event);
 }
 
 std::pair<bool, ashes::Direction4> GameAI::FindSafelyPathToFood()
 {
     using namespace navigation;
-    
-    if (BreadthFirstSearch(game_map_, food_, &snake_.Head().pos, dists_))
+
+    const GameMap& map = mirror_.GetGameMap();
+    const Snake& snake = mirror_.GetSnake();
+
+    if (dists_.Search(map, mirror_.GetFood(), &snake.Head().pos))
     {
-        if (BuildShortestPath(game_map_, snake_.Head().pos, food_, dists_,
-                snake_.Head().dir, dir_path_, coord_path_))
+        if (BuildShortestPath(map, snake.Head().pos, mirror_.GetFood(), dists_,
+                snake.Head().dir, dir_path_, coord_path_))
         {
             ashes::Direction4 dir = dir_path_.front();
-            MoveSnakeAlongPath(game_map_, snake_, dir_path_, true);
+            MoveSnakeAlongPath(mirror_, dir_path_, true);
 
-            if (snake_.Length() <= 1 || game_map_.NumSpaces() == 0 ||
-                FindPathToTail().first)
+            if (snake.Length() <= 1 || map.NumSpaces() == 0 ||
+                CanFindPathToTail())
             {
                 return {true, dir};
             }
@@ -254,11 +198,13 @@ std::pair<bool, ashes::Direction4> GameAI::FindPathToTail()
 {
     using namespace navigation;
 
-    if (BreadthFirstSearch(game_map_, snake_.Tail().pos,
-            &snake_.Head().pos, dists_))
+    const GameMap& map = mirror_.GetGameMap();
+    const Snake& snake = mirror_.GetSnake();
+
+    if (dists_.Search(map, snake.Tail().pos, &snake.Head().pos))
     {
-        if (BuildLongestPath(game_map_, snake_.Head().pos, snake_.Tail().pos,
-                dists_, snake_.Head().dir, dir_path_, coord_path_))
+        if (BuildLongestPath(mirror_, snake.Head().pos, snake.Tail().pos,
+                dists_, snake.Head().dir, dir_path_, coord_path_))
         {
             if (dir_path_.size() > 1)
             {
@@ -269,3 +215,36 @@ std::pair<bool, ashes::Direction4> GameAI::FindPathToTail()
 
     return {false, ashes::Direction4::Forward};
 }
+
+bool GameAI::CanFindPathToTail()
+{
+    const GameMap& map = mirror_.GetGameMap();
+    const Snake& snake = mirror_.GetSnake();
+
+    // the longest path is the shortest one detoured, it has more than one step
+    // unless the tail is adjacent to the head and no detour is beside them.
+    const int dist = flood_fill_.Distance(map, snake.Tail().pos, snake.Head().pos);
+    if (dist != 1)
+        return dist != INT_MAX;
+
+    for (ashes::Direction4 dir : ashes::direction4::kFullSet)
+    {
+        if (snake.Head().pos.Adjacency(dir) == snake.Tail().pos)
+        {
+            const ashes::Direction4 sides[] = {
+                ashes::direction4::LeftSideOf(dir),
+                ashes::direction4::RightSideOf(dir)};
+
+            for (ashes::Direction4 side : sides)
+            {
+                ashes::Coord coord1 = snake.Head().pos.Adjacency(side);
+                ashes::Coord coord2 = coord1.Adjacency(dir);
+                if (map.GetGridType(coord1) == GameMap::GridType::Space &&
+                    map.GetGridType(coord2) == GameMap::GridType::Space)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
@@ -6,6 +6,9 @@
 #include "ashes/coord.h"
 #include "ashes/direction4.h"
 #include "gamecore.h"
+#include "gamemirror.h"
+#include "distancefield.h"
+#include "floodfill.h"
 
 class GameAI
 {
@@ -17,18 +20,17 @@ public:
     GameAI& operator = (const GameAI&) = delete;
 
     ashes::Direction4 MakeStrategy(const GameCore& game);
+    void OnSnakeMoved(const GameCore::SnakeMoveEvent& event);
 
 private:
     
-    void CopyGameData(const GameCore& game);
     std::pair<bool, ashes::Direction4> FindSafelyPathToFood();
     std::pair<bool, ashes::Direction4> FindPathToTail();
+    bool CanFindPathToTail();
 
-    GameMap      game_map_;
-    Snake        snake_;
-    ashes::Coord food_ = {0, 0};
-
-    std::vector<int>               dists_;
+    GameMirror                     mirror_;
+    DistanceField                  dists_;
+    FloodFill                      flood_fill_;
     std::vector<ashes::Direction4> dir_path_;
     std::vector<ashes::Coord>      coord_path_;
 };
@@ -5,6 +5,12 @@
 using namespace std::chrono_literals;
 
 GameApp::GameApp()
+    : GameApp(ashes::time::GetRealClock())
+{
+}
+
+GameApp::GameApp(ashes::time::Clock& clock)
+    : SimpleConsoleApp(clock), game_(clock)
 {
     renderers_.push_back(GameRenderer::MakeLineStyleRenderer());
     renderers_.push_back(GameRenderer::MakeSquareStyleRenderer());
@@ -29,7 +35,26 @@ void GameApp::OnInit()
 
     // setup events. 
     game_.OnSnakeMoved.Bind(this, &GameApp::OnSnakeMoved);
-    GetTimerManager().NewTimer2(std::bind(&GameCore::TickGame, &game_), 5ms, true);
+    // listeners are called in reverse order, the AI follows a move first.
+    game_.OnSnakeMoved.Bind(&ai_, &GameAI::OnSnakeMoved);
+    tick_game_timer_ = GetTimerManager().NewTimer2(
+        std::bind(&GameApp::OnTickGame, this), game_.GetTickTimeout(), true);
+}
+
+void GameApp::OnBenchmarkFrame()
+{
+    // the AI plays games one after another, a move and a full draw per frame.
+    if (game_.GetGameState() != GameCore::GameState::UnderWay)
+    {
+        game_.ReadyGame();
+        game_.StartGame();
+        ai_enabled_ = true;
+        UpdateSnakeForwardDirection();
+    }
+
+    GetClock().Sleep(game_.GetTickTimeout());
+    game_.TickGame();
+    GetRenderer().DrawGaming(game_);
 }
 
 void GameApp::DealKeyEvent(WORD key, bool pressed)
@@ -57,6 +82,20 @@ void GameApp::DealKeyEvent(WORD key, bool pressed)
             case 'H':        OnToggleResultVisibility(); break;
         }
     }
+
+    // game state may be changed by keys.
+    ScheduleTickGame();
+}
+
+void GameApp::OnTickGame()
+{
+    game_.TickGame();
+    ScheduleTickGame();
+}
+
+void GameApp::ScheduleTickGame()
+{
+    GetTimerManager().SetTimer(tick_game_timer_, game_.GetTickTimeout(), true);
 }
 
 void GameApp::OnSnakeMoved(const GameCore::SnakeMoveEvent& event)
@@ -6,6 +6,7 @@
 #include <vector>
 #include "ashes/consoleapp.h"
 #include "ashes/direction4.h"
+#include "ashes/time.h"
 #include "gameai.h"
 #include "gamecore.h"
 #include "gamerenderer.h"
@@ -16,15 +17,19 @@ class GameApp : public ashes::SimpleConsoleApp
 public:
 
     GameApp();
+    explicit GameApp(ashes::time::Clock& clock);
     ~GameApp();
 
 protected:
 
     void OnInit() override;
+    void OnBenchmarkFrame() override;
     void DealKeyEvent(WORD key, bool pressed) override;
 
 private:
 
+    void OnTickGame();
+    void ScheduleTickGame();
     void OnSnakeMoved(const GameCore::SnakeMoveEvent& result);
     void OnSpaceKey();
     void OnEnterKey();
@@ -43,6 +48,7 @@ private:
 private:
 
     GameCore                                   game_;
+    ashes::TimerHandle                         tick_game_timer_ = nullptr;
     std::vector<std::unique_ptr<GameRenderer>> renderers_;
     std::size_t                                renderer_index_ = 0;
     bool                                       result_visible_ = false;
@@ -12,6 +12,12 @@ const std::vector<ashes::time::Msecs> GameCore::kSnakeMoveCooldowns = {
     505ms, 325ms, 185ms, 85ms, 25ms, 0ms};
 
 GameCore::GameCore()
+    : GameCore(ashes::time::GetRealClock())
+{
+}
+
+GameCore::GameCore(ashes::time::Clock& clock)
+    : clock_(clock)
 {
     game_map_.Resize(kGameMapSizeDef);
 }
@@ -111,7 +117,7 @@ void GameCore::ReadyGame()
     {
         game_state_ = GameState::Ready;
         game_map_.Clear();
-        snake_.Reset({{0, 0}, ashes::Direction4::Forward});
+        snake_.Reset({{0, 0}, ashes::Direction4::Forward}, game_map_.Size());
         food_ = {0, 0};
         snake_speed_level_ = 0;
         snake_move_timing_ = ashes::time::TimePoint();
@@ -144,7 +150,7 @@ void GameCore::TickGame()
 {
     if (game_state_ == GameState::UnderWay)
     {
-        ashes::time::TimePoint now = ashes::time::Now();
+        ashes::time::TimePoint now = clock_.Now();
 
         if (now >= snake_move_timing_)
         {
@@ -154,10 +160,19 @@ void GameCore::TickGame()
     }
 }
 
+ashes::time::Msecs GameCore::GetTickTimeout() const
+{
+    // TickGame does nothing until the snake can move.
+    if (game_state_ != GameState::UnderWay)
+        return ashes::time::Msecs::max();
+
+    return ashes::time::MsecsUntil(snake_move_timing_, clock_.Now());
+}
+
 void GameCore::PlaceSnakeOnCenterCoord()
 {
     ashes::Coord coord = {game_map_.Size().X / 2, game_map_.Size().Y / 2};
-    snake_.Reset({coord, ashes::direction4::Rand()});
+    snake_.Reset({coord, ashes::direction4::Rand()}, game_map_.Size());
     game_map_.SetGridType(coord, GameMap::GridType::Snake);
 }
 
@@ -169,7 +184,7 @@ void GameCore::PlaceFoodOnRandomCoord()
 
 void GameCore::ForwardMoveSnake()
 {
-    SnakeMoveEvent event = {snake_, SnakeMoveResult::Die, snake_.Tail()};
+    SnakeMoveEvent event = {snake_, SnakeMoveResult::Die, snake_.Tail(), food_};
     GameMap::GridType grid = game_map_.GetGridType(snake_.GetForwardCoord());
 
     if (grid == GameMap::GridType::Space)
@@ -18,12 +18,14 @@ public:
 
     struct SnakeMoveEvent
     {
-        const Snake&    snake;      // the moved snake.
-        SnakeMoveResult result;     // move result.
-        Snake::BodyNode tailprint;  // snake tail before move.
+        const Snake&        snake;      // the moved snake.
+        SnakeMoveResult     result;     // move result.
+        Snake::BodyNode     tailprint;  // snake tail before move.
+        const ashes::Coord& food;       // the food after move.
     };
 
     GameCore();
+    explicit GameCore(ashes::time::Clock& clock);
     GameCore(const GameCore&) = delete;
     ~GameCore();
     GameCore& operator = (const GameCore&) = delete;
@@ -43,6 +45,7 @@ public:
     void StartGame();
     void PauseGame(bool pause);
     void TickGame();
+    ashes::time::Msecs GetTickTimeout() const;
 
     ashes::EventDispatcher<void(SnakeMoveEvent)> OnSnakeMoved;
 
@@ -57,6 +60,7 @@ private:
     void PlaceFoodOnRandomCoord();
     void ForwardMoveSnake();
 
+    ashes::time::Clock&    clock_;
     GameState              game_state_ = GameState::Ready;
     GameMap                game_map_;
     Snake                  snake_;
@@ -23,20 +23,24 @@ const ashes::Coord& GameMap::Size() const
 
 int GameMap::NumGrids() const
 {
-    return static_cast<int>(grids_.size());
+    return size_.X * size_.Y;
 }
 
 int GameMap::NumSpaces() const
 {
-    return num_spaces_;
+    return static_cast<int>(spaces_.size());
 }
 
 void GameMap::Resize(const ashes::Coord& size)
 {
-    int num_grids = size.X * size.Y;
     size_ = size;
-    grids_.assign(num_grids, GridType::Space);
-    num_spaces_ = num_grids;
+    stride_ = size.X + 2;
+    grids_.assign(stride_ * (size.Y + 2), GridType::Wall);
+    num_row_words_ = (size.X + 63) / 64;
+    space_bits_.assign(num_row_words_ * size.Y, 0);
+    spaces_.reserve(NumGrids());
+    space_slots_.assign(NumIndices(), -1);
+    Clear();
 }
 
 bool GameMap::ValidateCoord(const ashes::Coord& coord) const
@@ -45,33 +49,32 @@ bool GameMap::ValidateCoord(const ashes::Coord& coord) const
         && (0 <= coord.Y && coord.Y < size_.Y);
 }
 
+int GameMap::NumIndices() const
+{
+    return static_cast<int>(grids_.size());
+}
+
 int GameMap::CoordToIndex(const ashes::Coord& coord) const
 {
-    return coord.X + coord.Y * size_.X;
+    return (coord.X + 1) + (coord.Y + 1) * stride_;
 }
 
 ashes::Coord GameMap::IndexToCoord(int index) const
 {
-    return {static_cast<SHORT>(index % size_.X), 
-            static_cast<SHORT>(index / size_.X)};
+    return {static_cast<SHORT>(index % stride_ - 1),
+            static_cast<SHORT>(index / stride_ - 1)};
 }
 
-ashes::Coord GameMap::RandSpaceCoord() const
+int GameMap::AdjacencyOffset(ashes::Direction4 dir) const
 {
-    int num_remain_spaces = num_spaces_;
-    int index = -1;
-
-    while (++index < NumGrids() && num_remain_spaces > 0)
-    {
-        if (grids_[index] == GridType::Space)
-        {
-            if (ashes::random::Probability(1.0f / num_remain_spaces))
-                break;
-            --num_remain_spaces;
-        }
-    }
+    const int offsets[] = {-1, -stride_, 1, stride_};
+    return offsets[ashes::direction4::ToInt(dir)];
+}
 
-    return IndexToCoord(index);
+ashes::Coord GameMap::RandSpaceCoord() const
+{
+    assert(!spaces_.empty());
+    return IndexToCoord(spaces_[ashes::random::Index(NumSpaces())]);
 }
 
 GameMap::GridType GameMap::GetGridType(const ashes::Coord& coord) const
@@ -79,20 +82,74 @@ GameMap::GridType GameMap::GetGridType(const ashes::Coord& coord) const
     return ValidateCoord(coord) ? grids_[CoordToIndex(coord)] : GridType::Wall;
 }
 
+GameMap::GridType GameMap::GetGridType(int index) const
+{
+    assert(0 <= index && index < NumIndices());
+    return grids_[index];
+}
+
+int GameMap::NumRowWords() const
+{
+    return num_row_words_;
+}
+
+const std::uint64_t* GameMap::GetSpaceRow(int y) const
+{
+    assert(0 <= y && y < size_.Y);
+    return space_bits_.data() + y * num_row_words_;
+}
+
 void GameMap::SetGridType(const ashes::Coord& coord, GridType type)
 {
     assert(ValidateCoord(coord));
     assert(type != GridType::Wall);
 
     int index = CoordToIndex(coord);
-    num_spaces_ -= (grids_[index] == GridType::Space);
-    num_spaces_ += (type == GridType::Space);
+    if (grids_[index] == GridType::Space && type != GridType::Space)
+    {
+        // move the last space into the slot of the removed one.
+        const int slot = space_slots_[index];
+        spaces_[slot] = spaces_.back();
+        space_slots_[spaces_[slot]] = slot;
+        spaces_.pop_back();
+        space_slots_[index] = -1;
+    }
+    else if (grids_[index] != GridType::Space && type == GridType::Space)
+    {
+        space_slots_[index] = static_cast<int>(spaces_.size());
+        spaces_.push_back(index);
+    }
+
+    std::uint64_t& word = space_bits_[coord.Y * num_row_words_ + coord.X / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (coord.X % 64);
+    word = (type == GridType::Space ? word | bit : word & ~bit);
 
     grids_[index] = type;
 }
 
 void GameMap::Clear()
 {
-    std::fill(grids_.begin(), grids_.end(), GridType::Space);
-    num_spaces_ = size_.X * size_.Y;
+    spaces_.clear();
+    for (SHORT y = 0; y < size_.Y; ++y)
+    {
+        auto row = grids_.begin() + CoordToIndex({0, y});
+        std::fill(row, row + size_.X, GridType::Space);
+
+        for (int index = CoordToIndex({0, y}); index < CoordToIndex({size_.X, y}); ++index)
+        {
+            space_slots_[index] = static_cast<int>(spaces_.size());
+            spaces_.push_back(index);
+        }
+    }
+
+    // bits beyond the row are kept clear, as the walls.
+    for (int y = 0; y < size_.Y; ++y)
+    {
+        std::uint64_t* row = space_bits_.data() + y * num_row_words_;
+        std::fill(row, row + num_row_words_, ~std::uint64_t(0));
+        if (size_.X % 64 != 0)
+        {
+            row[num_row_words_ - 1] = (std::uint64_t(1) << (size_.X % 64)) - 1;
+        }
+    }
 }
@@ -2,7 +2,9 @@
 #define GLUTTONOUSSNAKE_GAMEMAP_H
 
 #include <vector>
+#include <cstdint>
 #include "ashes/coord.h"
+#include "ashes/direction4.h"
 
 class GameMap
 {
@@ -19,20 +21,33 @@ public:
     int NumSpaces() const;
     void Resize(const ashes::Coord& size);
 
+    // grids are indexed in the map bordered by walls, so an adjacency of a grid
+    // in the map is at its index plus an offset, without bounds checks.
     bool ValidateCoord(const ashes::Coord& coord) const;
+    int NumIndices() const;
     int CoordToIndex(const ashes::Coord& coord) const;
     ashes::Coord IndexToCoord(int index) const;
+    int AdjacencyOffset(ashes::Direction4 dir) const;
 
     ashes::Coord RandSpaceCoord() const;
     GridType GetGridType(const ashes::Coord& coord) const;
+    GridType GetGridType(int index) const;
+
+    // spaces of a row as bits, the space at x is bit x % 64 of word x / 64.
+    int NumRowWords() const;
+    const std::uint64_t* GetSpaceRow(int y) const;
     void SetGridType(const ashes::Coord& coord, GridType type);
     void Clear();
 
 private:
 
-    ashes::Coord          size_ = {0, 0};
-    std::vector<GridType> grids_;
-    int                   num_spaces_ = 0;
+    ashes::Coord               size_ = {0, 0};
+    int                        stride_ = 0;   // of a row of bordered grids.
+    std::vector<GridType>      grids_;        // bordered by walls.
+    int                        num_row_words_ = 0;
+    std::vector<std::uint64_t> space_bits_;   // in rows of num_row_words_.
+    std::vector<int>           spaces_;       // indices of spaces, unordered.
+    std::vector<int>           space_slots_;  // of indices in spaces_, or -1.
 };
 
 #endif
\ No newline at end of file
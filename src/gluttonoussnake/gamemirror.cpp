@@ -0,0 +1,145 @@
+﻿#include "gamemirror.h"
+#include <cassert>
+
+GameMirror::GameMirror()
+{
+}
+
+GameMirror::~GameMirror()
+{
+}
+
+const GameMap& GameMirror::GetGameMap() const
+{
+    return game_map_;
+}
+
+const Snake& GameMirror::GetSnake() const
+{
+    return snake_;
+}
+
+const ashes::Coord& GameMirror::GetFood() const
+{
+    return food_;
+}
+
+void GameMirror::Sync(const GameCore& game)
+{
+    assert(grid_changes_.empty() && snake_steps_.empty());
+
+    if (!IsSame(game))
+    {
+        game_map_ = game.GetGameMap();
+        snake_ = game.GetSnake();
+        food_ = game.GetFood();
+        is_synced_ = true;
+    }
+
+    bool success = snake_.SetForwardDirection(game.GetSnake().Head().dir);
+    assert(success);
+}
+
+void GameMirror::OnSnakeMoved(const GameCore::SnakeMoveEvent& event)
+{
+    assert(grid_changes_.empty() && snake_steps_.empty());
+
+    if (!is_synced_ || event.result == GameCore::SnakeMoveResult::Die)
+        return;
+
+    // the forward direction may be changed after the move, take the one moved.
+    bool is_moved = false;
+    for (ashes::Direction4 dir : ashes::direction4::kFullSet)
+    {
+        if (snake_.Head().pos.Adjacency(dir) == event.snake.Head().pos)
+        {
+            is_moved = snake_.SetForwardDirection(dir);
+            break;
+        }
+    }
+
+    if (!is_moved)
+    {
+        is_synced_ = false;
+        return;
+    }
+
+    if (event.result == GameCore::SnakeMoveResult::Move)
+    {
+        snake_.MoveForward();
+        game_map_.SetGridType(event.tailprint.pos, GameMap::GridType::Space);
+        game_map_.SetGridType(snake_.Head().pos, GameMap::GridType::Snake);
+    }
+    else
+    {
+        snake_.GrowForward();
+        game_map_.SetGridType(snake_.Head().pos, GameMap::GridType::Snake);
+
+        if (event.result == GameCore::SnakeMoveResult::Grow)
+        {
+            food_ = event.food;
+            game_map_.SetGridType(food_, GameMap::GridType::Food);
+        }
+    }
+
+    is_synced_ = snake_.Length() == event.snake.Length()
+        && snake_.Tail().pos == event.snake.Tail().pos;
+}
+
+void GameMirror::SetGridType(const ashes::Coord& coord, GameMap::GridType type)
+{
+    grid_changes_.push_back({coord, game_map_.GetGridType(coord)});
+    game_map_.SetGridType(coord, type);
+}
+
+void GameMirror::MoveSnake(ashes::Direction4 dir, bool grow)
+{
+    if (snake_steps_.empty())
+    {
+        head_dir_ = snake_.Head().dir;
+    }
+
+    snake_steps_.push_back({snake_.Tail(), grow});
+    snake_.SetForwardDirection(dir);
+    grow ? snake_.GrowForward() : snake_.MoveForward();
+
+    if (!grow)
+    {
+        SetGridType(snake_steps_.back().tailprint.pos, GameMap::GridType::Space);
+    }
+    SetGridType(snake_.Head().pos, GameMap::GridType::Snake);
+}
+
+void GameMirror::Undo()
+{
+    for (auto iter = grid_changes_.rbegin(); iter != grid_changes_.rend(); ++iter)
+    {
+        game_map_.SetGridType(iter->coord, iter->type);
+    }
+    grid_changes_.clear();
+
+    if (!snake_steps_.empty())
+    {
+        for (auto iter = snake_steps_.rbegin(); iter != snake_steps_.rend(); ++iter)
+        {
+            iter->grow ? snake_.UndoGrowForward() : snake_.UndoMoveForward(iter->tailprint);
+        }
+        snake_steps_.clear();
+
+        bool success = snake_.SetForwardDirection(head_dir_);
+        assert(success);
+    }
+}
+
+bool GameMirror::IsSame(const GameCore& game) const
+{
+    // moves of a followed snake are all known, so the mirror is the same as
+    // the game if the snake and food are. a new game is found by them as well.
+    const Snake& snake = game.GetSnake();
+    return is_synced_
+        && game_map_.Size() == game.GetGameMap().Size()
+        && food_ == game.GetFood()
+        && snake_.Length() == snake.Length()
+        && snake_.Head().pos == snake.Head().pos
+        && snake_.Tail().pos == snake.Tail().pos;
+}
\ No newline at end of file
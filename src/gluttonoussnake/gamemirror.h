@@ -0,0 +1,64 @@
+﻿#ifndef GLUTTONOUSSNAKE_GAMEMIRROR_H
+#define GLUTTONOUSSNAKE_GAMEMIRROR_H
+
+#include <vector>
+#include "ashes/coord.h"
+#include "ashes/direction4.h"
+#include "gamecore.h"
+
+//==============================================================================
+// GameMirror: a copy of a game for the AI, which follows moves of the game's
+// snake and is copied again only when it can't. the AI changes it by virtual
+// moves, the changes are logged and undone once a decision is made.
+//==============================================================================
+
+class GameMirror
+{
+public:
+
+    GameMirror();
+    GameMirror(const GameMirror&) = delete;
+    ~GameMirror();
+    GameMirror& operator = (const GameMirror&) = delete;
+
+    const GameMap& GetGameMap() const;
+    const Snake& GetSnake() const;
+    const ashes::Coord& GetFood() const;
+
+    // copy the game if the mirror isn't the same, and take the forward direction
+    // of the game's snake, which is changed without events.
+    void Sync(const GameCore& game);
+    void OnSnakeMoved(const GameCore::SnakeMoveEvent& event);
+
+    // virtual changes, which are logged until undone.
+    void SetGridType(const ashes::Coord& coord, GameMap::GridType type);
+    void MoveSnake(ashes::Direction4 dir, bool grow);
+    void Undo();
+
+private:
+
+    struct GridChange
+    {
+        ashes::Coord      coord;
+        GameMap::GridType type;  // before the change.
+    };
+
+    struct SnakeStep
+    {
+        Snake::BodyNode tailprint;  // snake tail before the step.
+        bool            grow;
+    };
+
+    bool IsSame(const GameCore& game) const;
+
+    GameMap      game_map_;
+    Snake        snake_;
+    ashes::Coord food_ = {0, 0};
+    bool         is_synced_ = false;
+
+    std::vector<GridChange> grid_changes_;
+    std::vector<SnakeStep>  snake_steps_;
+    ashes::Direction4       head_dir_ = ashes::Direction4::Forward;  // before steps.
+};
+
+#endif
\ No newline at end of file
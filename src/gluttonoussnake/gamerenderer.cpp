@@ -1,6 +1,5 @@
 ﻿#include "gamerenderer.h"
 #include <vector>
-#include <tchar.h>
 #include "ashes/coord.h"
 #include "ashes/graph.h"
 #include "ashes/console.h"
@@ -1,7 +1,31 @@
-﻿#include "gameapp.h"
+﻿#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include "ashes/console.h"
+#include "ashes/time.h"
+#include "gameapp.h"
 
-int main()
+// usage: --benchmark-render [frames]
+bool RunRenderBenchmark(int argc, char* argv[])
 {
+    if (argc < 2 || std::strcmp(argv[1], "--benchmark-render") != 0)
+        return false;
+
+    const std::size_t num_frames = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000);
+
+    // draw headless, the game runs on a virtual clock without waits.
+    ashes::Console::SetBackend(ashes::ConsoleBackend::MakeNullBackend({80, 25}));
+    ashes::time::VirtualClock clock;
+    GameApp app(clock);
+    app.RunRenderBenchmark(num_frames, std::cout);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (RunRenderBenchmark(argc, argv))
+        return 0;
+
     GameApp app;
     app.Run();
     return 0;
@@ -1,10 +1,9 @@
 ﻿#include "snake.h"
 #include <cassert>
-#include <algorithm>
 
 Snake::Snake()
 {
-    Reset({{0, 0}, ashes::Direction4::Forward});
+    Reset({{0, 0}, ashes::Direction4::Forward}, {1, 1});
 }
 
 Snake::~Snake()
@@ -13,23 +12,34 @@ Snake::~Snake()
 
 const Snake::BodyNode& Snake::Head() const
 {
-    return body_.front();
+    return Node(0);
 }
 
 const Snake::BodyNode& Snake::Tail() const
 {
-    return body_.back();
+    return Node(length_ - 1);
 }
 
 const Snake::BodyNode& Snake::Node(int index) const
 {
     assert(0 <= index && index < Length());
-    return body_[index];
+    const int slot = head_slot_ + index;
+    const int capacity = static_cast<int>(ring_.size());
+    return ring_[slot < capacity ? slot : slot - capacity];
 }
 
 int Snake::Length() const
 {
-    return static_cast<int>(body_.size());
+    return length_;
+}
+
+bool Snake::Occupies(const ashes::Coord& pos) const
+{
+    if (pos.X < 0 || pos.X >= map_size_.X || pos.Y < 0 || pos.Y >= map_size_.Y)
+        return false;
+
+    const int bit_index = pos.X + pos.Y * map_size_.X;
+    return (occupied_bits_[bit_index / 64] >> (bit_index % 64) & 1) != 0;
 }
 
 ashes::Coord Snake::GetForwardCoord() const
@@ -39,9 +49,9 @@ ashes::Coord Snake::GetForwardCoord() const
 
 bool Snake::SetForwardDirection(ashes::Direction4 dir)
 {
-    if (body_.size() <= 1 || dir != ashes::direction4::NegativeOf(body_[1].dir))
+    if (length_ <= 1 || dir != ashes::direction4::NegativeOf(Node(1).dir))
     {
-        body_[0].dir = dir;
+        ring_[head_slot_].dir = dir;
         return true;
     }
     return false;
@@ -49,25 +59,107 @@ bool Snake::SetForwardDirection(ashes::Direction4 dir)
 
 void Snake::MoveForward()
 {
-    GrowForward();
-    body_.pop_back();
+    // the tail leaves first, so the head can take its grid.
+    const BodyNode head = {GetForwardCoord(), Head().dir};
+    PopBack();
+    PushFront(head);
 }
 
 void Snake::GrowForward()
 {
-    body_.push_front({GetForwardCoord(), Head().dir});
-    assert(Validate());
+    PushFront({GetForwardCoord(), Head().dir});
+}
+
+void Snake::UndoMoveForward(const BodyNode& tailprint)
+{
+    PopFront();
+    PushBack(tailprint);
+}
+
+void Snake::UndoGrowForward()
+{
+    assert(length_ > 1);
+    PopFront();
 }
 
 bool Snake::Validate() const
 {
-    auto iter = std::adjacent_find(body_.rbegin(), body_.rend(),
-        [](const BodyNode& next, const BodyNode& prev) {
-            return next.pos.Adjacency(next.dir) != prev.pos; });
-    return iter == body_.rend();
+    for (int index = 1; index < length_; ++index)
+    {
+        const BodyNode& node = Node(index);
+        if (node.pos.Adjacency(node.dir) != Node(index - 1).pos)
+            return false;
+    }
+    return true;
+}
+
+void Snake::Reset(const BodyNode& head, const ashes::Coord& map_size)
+{
+    assert(map_size.X > 0 && map_size.Y > 0);
+
+    if (map_size != map_size_)
+    {
+        const int num_grids = map_size.X * map_size.Y;
+        map_size_ = map_size;
+        ring_.resize(num_grids);
+        occupied_bits_.assign((num_grids + 63) / 64, 0);
+    }
+    else
+    {
+        while (length_ > 0) { PopBack(); }
+    }
+
+    head_slot_ = 0;
+    length_ = 0;
+    PushFront(head);
+}
+
+void Snake::PushFront(const BodyNode& node)
+{
+    // the body stays valid if the new head is where the head points to.
+    assert(length_ < static_cast<int>(ring_.size()));
+    assert(length_ == 0 || Head().pos.Adjacency(Head().dir) == node.pos);
+    assert(!Occupies(node.pos));
+
+    head_slot_ = (head_slot_ > 0 ? head_slot_ : static_cast<int>(ring_.size())) - 1;
+    ring_[head_slot_] = node;
+    ++length_;
+    SetOccupied(node.pos, true);
+}
+
+void Snake::PushBack(const BodyNode& node)
+{
+    assert(length_ < static_cast<int>(ring_.size()));
+    assert(length_ == 0 || node.pos.Adjacency(node.dir) == Tail().pos);
+    assert(!Occupies(node.pos));
+
+    ++length_;
+    const int slot = head_slot_ + length_ - 1;
+    const int capacity = static_cast<int>(ring_.size());
+    ring_[slot < capacity ? slot : slot - capacity] = node;
+    SetOccupied(node.pos, true);
+}
+
+void Snake::PopFront()
+{
+    assert(length_ > 0);
+    SetOccupied(Head().pos, false);
+    head_slot_ = (head_slot_ + 1 < static_cast<int>(ring_.size()) ? head_slot_ + 1 : 0);
+    --length_;
+}
+
+void Snake::PopBack()
+{
+    assert(length_ > 0);
+    SetOccupied(Tail().pos, false);
+    --length_;
 }
 
-void Snake::Reset(const BodyNode& head)
+void Snake::SetOccupied(const ashes::Coord& pos, bool occupied)
 {
-    body_.assign(1, head);
+    assert(0 <= pos.X && pos.X < map_size_.X && 0 <= pos.Y && pos.Y < map_size_.Y);
+    const int bit_index = pos.X + pos.Y * map_size_.X;
+    const std::uint64_t bit = std::uint64_t(1) << (bit_index % 64);
+    std::uint64_t& word = occupied_bits_[bit_index / 64];
+    word = (occupied ? word | bit : word & ~bit);
 }
\ No newline at end of file
@@ -1,7 +1,8 @@
 ﻿#ifndef GLUTTONOUSSNAKE_SNAKE_H
 #define GLUTTONOUSSNAKE_SNAKE_H
 
-#include <deque>
+#include <vector>
+#include <cstdint>
 #include "ashes/coord.h"
 #include "ashes/direction4.h"
 
@@ -22,18 +23,36 @@ public:
     const BodyNode& Tail() const;
     const BodyNode& Node(int index) const;
     int Length() const;
+    bool Occupies(const ashes::Coord& pos) const;
 
     ashes::Coord GetForwardCoord() const;
     bool SetForwardDirection(ashes::Direction4 dir);
     void MoveForward();
     void GrowForward();
+
+    // take back the last move, with the snake tail before it.
+    void UndoMoveForward(const BodyNode& tailprint);
+    void UndoGrowForward();
     
     bool Validate() const;
-    void Reset(const BodyNode& head);
+
+    // the body is kept in a ring with room for all grids of the map, so it
+    // is never reallocated until reset for another map size.
+    void Reset(const BodyNode& head, const ashes::Coord& map_size);
 
 private:
 
-    std::deque<BodyNode> body_;
+    void PushFront(const BodyNode& node);
+    void PushBack(const BodyNode& node);
+    void PopFront();
+    void PopBack();
+    void SetOccupied(const ashes::Coord& pos, bool occupied);
+
+    ashes::Coord               map_size_ = {0, 0};
+    std::vector<BodyNode>      ring_;
+    int                        head_slot_ = 0;  // of the head in ring_.
+    int                        length_ = 0;
+    std::vector<std::uint64_t> occupied_bits_;  // of grids in map rows.
 };
 
 #endif
\ No newline at end of file
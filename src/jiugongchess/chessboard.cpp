@@ -1,52 +1,101 @@
 ﻿#include "chessboard.h"
+#include <vector>
 #include <cassert>
 #include <algorithm>
 
+namespace {
+
+typedef std::array<Chessboard::GridMask, Chessboard::kNumGrids> AdjacencyMasks;
+typedef std::array<bool, Chessboard::kFullMask + 1>             LineMaskTable;
+
+AdjacencyMasks MakeAdjacencyMasks()
+{
+    static const bool kAdjacencyMatrix[Chessboard::kNumGrids][Chessboard::kNumGrids] = {
+        {false, true,  false, true,  true,  false, false, false, false},
+        {true,  false, true,  false, true,  false, false, false, false},
+        {false, true,  false, false, true,  true,  false, false, false},
+        {true,  false, false, false, true,  false, true,  false, false},
+        {true,  true,  true,  true,  false, true,  true,  true,  true },
+        {false, false, true,  false, true,  false, false, false, true },
+        {false, false, false, true,  true,  false, false, true,  false},
+        {false, false, false, false, true,  false, true,  false, true },
+        {false, false, false, false, true,  true,  false, true,  false}};
+
+    AdjacencyMasks masks = {};
+    for (int index1 = 0; index1 < Chessboard::kNumGrids; ++index1)
+    {
+        for (int index2 = 0; index2 < Chessboard::kNumGrids; ++index2)
+        {
+            if (kAdjacencyMatrix[index1][index2])
+            {
+                masks[index1] |= static_cast<Chessboard::GridMask>(1 << index2);
+            }
+        }
+    }
+    return masks;
+}
+
+// a mask is a line if it has 3 grids with same coord difference in order.
+LineMaskTable MakeLineMaskTable()
+{
+    LineMaskTable table = {};
+    for (int mask = 0; mask <= Chessboard::kFullMask; ++mask)
+    {
+        std::vector<Chessboard::Coord> coords;
+        for (int index = 0; index < Chessboard::kNumGrids; ++index)
+        {
+            if (mask & (1 << index)) { coords.push_back(Chessboard::IndexToCoord(index)); }
+        }
+
+        table[mask] = coords.size() == 3
+            && coords[1] - coords[0] == coords[2] - coords[1];
+    }
+    return table;
+}
+
+}
+
 Chessboard::Chessboard()
     : Chessboard(GetInitialGridStorage())
 {
 }
 
 Chessboard::Chessboard(const GridStorage& grids)
-    : grids_(grids)
+    : sente_mask_(MakeGridMask(grids, GridType::SentePiece))
+    , gote_mask_(MakeGridMask(grids, GridType::GotePiece))
 {
     assert(ValidateGridStorage(grids));
 }
 
+Chessboard::Chessboard(GridMask sente_mask, GridMask gote_mask)
+    : sente_mask_(sente_mask)
+    , gote_mask_(gote_mask)
+{
+}
+
 Chessboard::~Chessboard()
 {
 }
 
 bool Chessboard::IsPlayerWin(PlayerSide player) const
 {
-    static const std::vector<Coord> kInitialSentePieceCoords =
-        FindGridCoords(GetInitialGridStorage(), GridType::SentePiece);
-
-    static const std::vector<Coord> kInitialGotePieceCoords =
-        FindGridCoords(GetInitialGridStorage(), GridType::GotePiece);
-
-    const std::vector<Coord>& initial_piece_coords = (player == PlayerSide::Sente
-        ? kInitialSentePieceCoords : kInitialGotePieceCoords);
-
-    const std::vector<Coord> piece_coords =
-        FindGridCoords(grids_, PieceTypeOwnedByPlayer(player));
-
-    return piece_coords[1] - piece_coords[0] == piece_coords[2] - piece_coords[1]
-        && piece_coords != initial_piece_coords;
+    const GridMask mask = GetPieceMask(player);
+    return IsLineMask(mask) && mask != GetInitialPieceMask(player);
 }
 
 void Chessboard::MovePiece(const PieceStep& step)
 {
     assert(CanMovePiece(step));
-    int piece_index = CoordToIndex(step.first);
-    int space_index = CoordToIndex(step.second);
-    grids_[space_index] = grids_[piece_index];
-    grids_[piece_index] = GridType::Space;
+    const GridMask step_mask = static_cast<GridMask>(
+        1 << CoordToIndex(step.first) | 1 << CoordToIndex(step.second));
+    GridMask& mask = (sente_mask_ & step_mask) ? sente_mask_ : gote_mask_;
+    mask ^= step_mask;
 }
 
 void Chessboard::Reset()
 {
-    grids_ = GetInitialGridStorage();
+    sente_mask_ = GetInitialPieceMask(PlayerSide::Sente);
+    gote_mask_ = GetInitialPieceMask(PlayerSide::Gote);
 }
 
 bool Chessboard::ValidateCoord(const Coord& coord)
@@ -62,7 +111,7 @@ int Chessboard::CoordToIndex(const Coord& coord)
 
 Chessboard::Coord Chessboard::IndexToCoord(int index)
 {
-    return {static_cast<SHORT>(index % kNumCols), 
+    return {static_cast<SHORT>(index % kNumCols),
             static_cast<SHORT>(index / kNumCols)};
 }
 
@@ -82,9 +131,14 @@ const Chessboard::GridStorage& Chessboard::GetInitialGridStorage()
     return kGrids;
 }
 
-const Chessboard::GridStorage& Chessboard::GetGridStorage() const
+Chessboard::GridStorage Chessboard::GetGridStorage() const
 {
-    return grids_;
+    GridStorage grids;
+    for (int index = 0; index < kNumGrids; ++index)
+    {
+        grids[index] = GetGridType(IndexToCoord(index));
+    }
+    return grids;
 }
 
 int Chessboard::CountGrid(GridType type)
@@ -95,7 +149,80 @@ int Chessboard::CountGrid(GridType type)
 Chessboard::GridType Chessboard::GetGridType(const Coord& coord) const
 {
     assert(ValidateCoord(coord));
-    return grids_[CoordToIndex(coord)];
+    const GridMask grid_mask = static_cast<GridMask>(1 << CoordToIndex(coord));
+    return (sente_mask_ & grid_mask) ? GridType::SentePiece
+         : (gote_mask_ & grid_mask)  ? GridType::GotePiece
+         : GridType::Space;
+}
+
+Chessboard::GridMask Chessboard::GetAdjacencyMask(int index)
+{
+    static const AdjacencyMasks kAdjacencyMasks = MakeAdjacencyMasks();
+    assert(0 <= index && index < kNumGrids);
+    return kAdjacencyMasks[index];
+}
+
+bool Chessboard::IsLineMask(GridMask mask)
+{
+    static const LineMaskTable kLineMaskTable = MakeLineMaskTable();
+    assert(mask <= kFullMask);
+    return kLineMaskTable[mask];
+}
+
+int Chessboard::LowestGridIndex(GridMask mask)
+{
+    assert(mask != 0);
+    int index = 0;
+    for (; (mask & 1) == 0; mask >>= 1) { ++index; }
+    return index;
+}
+
+Chessboard::GridMask Chessboard::GetPieceMask(PlayerSide player) const
+{
+    return player == PlayerSide::Sente ? sente_mask_ : gote_mask_;
+}
+
+Chessboard::GridMask Chessboard::GetSpaceMask() const
+{
+    return static_cast<GridMask>(kFullMask & ~(sente_mask_ | gote_mask_));
+}
+
+Chessboard::Coord Chessboard::MirrorCoord(const Coord& coord)
+{
+    assert(ValidateCoord(coord));
+    return {static_cast<SHORT>(kNumCols - 1 - coord.X), coord.Y};
+}
+
+Chessboard::PieceStep Chessboard::MirrorStep(const PieceStep& step)
+{
+    return {MirrorCoord(step.first), MirrorCoord(step.second)};
+}
+
+Chessboard::GridMask Chessboard::MirrorMask(GridMask mask)
+{
+    static const auto kMirrorMasks = []() {
+        std::array<GridMask, kFullMask + 1> masks = {};
+        for (int mask = 0; mask <= kFullMask; ++mask)
+        {
+            for (int index = 0; index < kNumGrids; ++index)
+            {
+                if (mask & (1 << index))
+                {
+                    int mirror_index = CoordToIndex(MirrorCoord(IndexToCoord(index)));
+                    masks[mask] |= static_cast<GridMask>(1 << mirror_index);
+                }
+            }
+        }
+        return masks;
+    }();
+
+    assert(mask <= kFullMask);
+    return kMirrorMasks[mask];
+}
+
+Chessboard Chessboard::GetMirror() const
+{
+    return Chessboard(MirrorMask(sente_mask_), MirrorMask(gote_mask_));
 }
 
 Chessboard::GridType Chessboard::PieceTypeOwnedByPlayer(PlayerSide player)
@@ -128,72 +255,59 @@ bool Chessboard::CanMovePiece(const PieceStep& step) const
     int piece_index = CoordToIndex(step.first);
     int space_index = CoordToIndex(step.second);
 
-    return grids_[piece_index] != GridType::Space
-        && grids_[space_index] == GridType::Space
+    return ((sente_mask_ | gote_mask_) & (1 << piece_index))
+        && (GetSpaceMask() & (1 << space_index))
         && IsGridConnected(piece_index, space_index);
 }
 
 void Chessboard::GetOptionalMove(
-    const Coord& piece, 
-    std::vector<PieceStep>& steps) const
+    const Coord& piece,
+    MoveList& steps) const
 {
-    for (int index = 0; index < kNumGrids; ++index)
-    {
-        PieceStep step = {piece, IndexToCoord(index)};
+    const int piece_index = CoordToIndex(piece);
+    if (((sente_mask_ | gote_mask_) & (1 << piece_index)) == 0)
+        return;
 
-        if (CanMovePiece(step))
-        {
-            steps.push_back(step);
-        }
+    for (GridMask spaces = GetAdjacencyMask(piece_index) & GetSpaceMask();
+         spaces != 0; spaces &= spaces - 1)
+    {
+        steps.push_back({piece, IndexToCoord(LowestGridIndex(spaces))});
     }
 }
 
 void Chessboard::GetOptionalMove(
     PlayerSide player,
-    std::vector<PieceStep>& steps) const
+    MoveList& steps) const
 {
-    const std::vector<Coord> coords = FindGridCoords(
-        grids_, PieceTypeOwnedByPlayer(player));
-
-    for (const Coord& coord : coords)
-    {
-        GetOptionalMove(coord, steps);
-    }
+    ForEachOptionalMove(player, [&steps](const PieceStep& step) { steps.push_back(step); });
 }
 
 bool Chessboard::IsGridConnected(int index1, int index2)
 {
-    static const bool kAdjacencyMatrix[kNumGrids][kNumGrids] = {
-        {false, true,  false, true,  true,  false, false, false, false},
-        {true,  false, true,  false, true,  false, false, false, false},
-        {false, true,  false, false, true,  true,  false, false, false},
-        {true,  false, false, false, true,  false, true,  false, false},
-        {true,  true,  true,  true,  false, true,  true,  true,  true },
-        {false, false, true,  false, true,  false, false, false, true },
-        {false, false, false, true,  true,  false, false, true,  false},
-        {false, false, false, false, true,  false, true,  false, true },
-        {false, false, false, false, true,  true,  false, true,  false}};
-
-    assert(0 <= index1 && index1 < kNumGrids);
     assert(0 <= index2 && index2 < kNumGrids);
-
-    return kAdjacencyMatrix[index1][index2];
+    return (GetAdjacencyMask(index1) & (1 << index2)) != 0;
 }
 
-std::vector<Chessboard::Coord> Chessboard::FindGridCoords(
+Chessboard::GridMask Chessboard::MakeGridMask(
     const GridStorage& grids,
     GridType type)
 {
-    std::vector<Coord> coords;
-
+    GridMask mask = 0;
     for (int index = 0; index < kNumGrids; ++index)
     {
         if (grids[index] == type)
         {
-            coords.push_back(IndexToCoord(index));
+            mask |= static_cast<GridMask>(1 << index);
         }
     }
+    return mask;
+}
 
-    assert(static_cast<int>(coords.size()) == CountGrid(type));
-    return coords;
+Chessboard::GridMask Chessboard::GetInitialPieceMask(PlayerSide player)
+{
+    static const GridMask kSenteMask =
+        MakeGridMask(GetInitialGridStorage(), GridType::SentePiece);
+    static const GridMask kGoteMask =
+        MakeGridMask(GetInitialGridStorage(), GridType::GotePiece);
+    return player == PlayerSide::Sente ? kSenteMask : kGoteMask;
 }
\ No newline at end of file
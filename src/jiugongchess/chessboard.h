@@ -2,10 +2,20 @@
 #define ASHES_JIUGONGCHESS_CHESSBOARD_H
 
 #include <array>
-#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <utility>
 #include "ashes/coord.h"
 
+//==============================================================================
+// Chessboard: 
+// 
+// Grids are stored as bitboards, a 9-bit mask of grid indexes for each player,
+// so move generation and win check are table lookups and bit operations:
+// adjacency masks of each grid, and a 512-entry table of masks forming a line.
+//==============================================================================
+
 class Chessboard
 {
 public:
@@ -21,6 +31,7 @@ public:
     static const int kNumGrids = kNumRows * kNumCols;
     static const int kNumPiecesEachPlayer = 3;
     static const int kNumSpaces = kNumGrids - 2 * kNumPiecesEachPlayer;
+    static const int kNumMaxMoves = kNumPiecesEachPlayer * kNumSpaces;
     
     enum class PlayerSide { Sente, Gote };
     enum class GridType { Space, SentePiece, GotePiece };
@@ -28,6 +39,26 @@ public:
     typedef ashes::Coord                    Coord;
     typedef std::pair<Coord, Coord>         PieceStep;
     typedef std::array<GridType, kNumGrids> GridStorage;
+    typedef std::uint16_t                   GridMask;  // bit i for grid index i.
+
+    // fixed capacity list of steps, for optional moves without heap.
+    class MoveList
+    {
+    public:
+        typedef const PieceStep* const_iterator;
+
+        void push_back(const PieceStep& step);
+        void clear();
+        bool empty() const;
+        std::size_t size() const;
+        const PieceStep& operator [] (std::size_t index) const;
+        const_iterator begin() const;
+        const_iterator end() const;
+
+    private:
+        std::array<PieceStep, kNumMaxMoves> steps_;
+        std::size_t                         size_ = 0;
+    };
 
     //==========================================================================
     // Play game
@@ -51,11 +82,33 @@ public:
 
     static bool ValidateGridStorage(const GridStorage& grids);
     static const GridStorage& GetInitialGridStorage();
-    const GridStorage& GetGridStorage() const;
+    GridStorage GetGridStorage() const;
 
     static int CountGrid(GridType type);
     GridType GetGridType(const Coord& coord) const;
 
+    //==========================================================================
+    // Bitboards
+    //==========================================================================
+
+    static const GridMask kFullMask = (1 << kNumGrids) - 1;
+
+    static GridMask GetAdjacencyMask(int index);
+    static bool IsLineMask(GridMask mask);
+    static int LowestGridIndex(GridMask mask);  // mask must not be zero.
+    GridMask GetPieceMask(PlayerSide player) const;
+    GridMask GetSpaceMask() const;
+
+    //==========================================================================
+    // Symmetry
+    // grids, adjacency and win test are invariant under left-right mirror.
+    //==========================================================================
+
+    static Coord MirrorCoord(const Coord& coord);
+    static PieceStep MirrorStep(const PieceStep& step);
+    static GridMask MirrorMask(GridMask mask);
+    Chessboard GetMirror() const;
+
     //==========================================================================
     // Pieces & Players
     //==========================================================================
@@ -66,8 +119,12 @@ public:
     
     bool CanMovePiece(PlayerSide player, const PieceStep& step) const;
     bool CanMovePiece(const PieceStep& step) const;
-    void GetOptionalMove(const Coord& piece, std::vector<PieceStep>& steps) const;
-    void GetOptionalMove(PlayerSide player, std::vector<PieceStep>& steps) const;
+    void GetOptionalMove(const Coord& piece, MoveList& steps) const;
+    void GetOptionalMove(PlayerSide player, MoveList& steps) const;
+
+    // visit optional moves of the player in the same order as above.
+    template <class Visitor>
+    void ForEachOptionalMove(PlayerSide player, Visitor visitor) const;
 
 private:
 
@@ -76,9 +133,67 @@ private:
     //==========================================================================
 
     static bool IsGridConnected(int index1, int index2);
-    static std::vector<Coord> FindGridCoords(const GridStorage& grids, GridType type);
-    
-    GridStorage grids_;
+    static GridMask MakeGridMask(const GridStorage& grids, GridType type);
+    static GridMask GetInitialPieceMask(PlayerSide player);
+    Chessboard(GridMask sente_mask, GridMask gote_mask);
+
+    GridMask sente_mask_ = 0;  // grids of sente pieces.
+    GridMask gote_mask_ = 0;   // grids of gote pieces.
 };
 
+inline void Chessboard::MoveList::push_back(const PieceStep& step)
+{
+    assert(size_ < steps_.size());
+    steps_[size_++] = step;
+}
+
+inline void Chessboard::MoveList::clear()
+{
+    size_ = 0;
+}
+
+inline bool Chessboard::MoveList::empty() const
+{
+    return size_ == 0;
+}
+
+inline std::size_t Chessboard::MoveList::size() const
+{
+    return size_;
+}
+
+inline auto Chessboard::MoveList::operator [] (std::size_t index) const -> const PieceStep&
+{
+    assert(index < size_);
+    return steps_[index];
+}
+
+inline auto Chessboard::MoveList::begin() const -> const_iterator
+{
+    return steps_.data();
+}
+
+inline auto Chessboard::MoveList::end() const -> const_iterator
+{
+    return steps_.data() + size_;
+}
+
+template <class Visitor>
+void Chessboard::ForEachOptionalMove(PlayerSide player, Visitor visitor) const
+{
+    const GridMask space_mask = GetSpaceMask();
+
+    for (GridMask pieces = GetPieceMask(player); pieces != 0; pieces &= pieces - 1)
+    {
+        const int piece_index = LowestGridIndex(pieces);
+        const Coord piece = IndexToCoord(piece_index);
+
+        for (GridMask spaces = GetAdjacencyMask(piece_index) & space_mask;
+             spaces != 0; spaces &= spaces - 1)
+        {
+            visitor(PieceStep(piece, IndexToCoord(LowestGridIndex(spaces))));
+        }
+    }
+}
+
 #endif
\ No newline at end of file
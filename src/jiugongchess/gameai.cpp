@@ -1,9 +1,8 @@
 ﻿#include "gameai.h"
 
-#include <string>
 #include <cassert>
-#include <sstream>
-#include <iterator>
+#include <cstdlib>
+#include <iostream>
 #include <algorithm>
 
 #include "ashes/math.h"
@@ -31,65 +30,104 @@ void GameAI::SetIQ(int min, int max)
     iq_max_ = max;
 }
 
-Chessboard::PieceStep GameAI::HandleGameTurn(const Chessboard& chessboard) const
+void GameAI::SetLevel(Level level)
 {
-    U32GameSituation key = GameSolver::CompressSituation(chessboard, role_);
-    assert(GetDatabse().count(key) == 1);
-    const std::vector<U32Strategy>& strategys = GetDatabse().find(key)->second;
-    assert(!strategys.empty());
+    static const int kIQMins[kNumLevels] = {0,  2,  30};
+    static const int kIQMaxs[kNumLevels] = {20, 22, 30};
+    int index = static_cast<int>(level);
+    SetIQ(kIQMins[index], kIQMaxs[index]);
+}
 
-    int iq = ashes::math::Lerp(iq_min_, iq_max_, ashes::random::Uniform());
-    U32Strategy needle = static_cast<U32Strategy>(iq << 8);
-    auto iter = std::lower_bound(strategys.begin(), strategys.end(), needle);
-    U32Strategy strategy = (iter == strategys.end() ? strategys.back() : *iter);
+Chessboard::PieceStep GameAI::HandleGameTurn(const Chessboard& chessboard) const
+{
+    return HandleGameTurn(chessboard, ashes::random::Uniform());
+}
 
-    Chessboard::PieceStep step = GameSolver::DeCompressStrategy(strategy).step;
+Chessboard::PieceStep GameAI::HandleGameTurn(
+    const Chessboard& chessboard,
+    float uniform) const
+{
+    Chessboard canonical_chessboard = chessboard;
+    const bool mirrored = GameSolver::CanonicalizeChessboard(canonical_chessboard);
+    const std::uint32_t rank = GameSolver::RankSituation(canonical_chessboard, role_);
+    const int iq = ashes::math::Lerp(iq_min_, iq_max_, uniform);
+    const Chessboard::PieceStep step = PickStep(GetDatabse().GetStrategys(rank), iq, mirrored);
     assert(chessboard.CanMovePiece(step));
     return step;
 }
 
-GameAI::Database GameAI::LoadDatabase()
+void GameAI::HandleGameTurns(
+    const TurnRequest* requests,
+    std::size_t num_requests,
+    Chessboard::PieceStep* steps)
 {
-    const char* name = MAKEINTRESOURCEA(IDR_DAT_GAMEAI_DATABASE);
-    const std::string resource = ashes::win::LoadModuleResource(name, "dat");
-    assert(!resource.empty());
-    Database database;
+    const std::size_t kBlockSize = 16;
+    const GameDatabase& database = GetDatabse();
+    std::uint32_t ranks[kBlockSize];
+    bool mirroreds[kBlockSize];
 
-    for (std::stringstream stream(resource); stream.good();)
+    for (std::size_t first = 0; first < num_requests; first += kBlockSize)
     {
-        std::istream_iterator<int> iter(stream);
-        
-        int chessboard = *iter++;
-        int num_steps = *iter++;
-        assert(database.count(chessboard) == 0);
-        assert(num_steps > 0);
-
-        auto& steps = database[chessboard];
-        steps.resize(num_steps);
-        std::copy_n(iter, num_steps, steps.begin());
-    }
+        // rank all situations of a block and prefetch their strategys first,
+        // so lookups of the block don't wait for memory one by one.
+        const std::size_t block_size = (std::min)(kBlockSize, num_requests - first);
+        for (std::size_t i = 0; i < block_size; ++i)
+        {
+            Chessboard canonical_chessboard = requests[first + i].chessboard;
+            mirroreds[i] = GameSolver::CanonicalizeChessboard(canonical_chessboard);
+            ranks[i] = GameSolver::RankSituation(canonical_chessboard, requests[first + i].role);
+            database.PrefetchStrategys(ranks[i]);
+        }
 
-    assert(ValidateDatabase(database));
-    return database;
+        for (std::size_t i = 0; i < block_size; ++i)
+        {
+            const TurnRequest& request = requests[first + i];
+            steps[first + i] = PickStep(database.GetStrategys(ranks[i]), request.iq, mirroreds[i]);
+            assert(request.chessboard.CanMovePiece(request.role, steps[first + i]));
+        }
+    }
 }
 
-bool GameAI::ValidateDatabase(const Database& database)
+GameDatabase GameAI::LoadDatabase()
 {
-    for (const auto& row : database)
+    // the resource stays mapped with the module, so it is used in place.
+#ifdef _WIN32
+    const char* name = MAKEINTRESOURCEA(IDR_DAT_GAMEAI_DATABASE);
+#else
+    const char* name = "gameaidatabase.dat";
+#endif
+    const auto resource = ashes::win::LockModuleResource(name, "dat");
+    GameDatabase database;
+    bool success = database.Attach(resource.first, resource.second);
+    assert(success);
+    if (!success)
     {
-        const auto situation = GameSolver::DeCompressSituation(row.first);
-        for (U32Strategy u32_strategy : row.second)
-        {
-            const auto strategy = GameSolver::DeCompressStrategy(u32_strategy);
-            if (!situation.first.CanMovePiece(situation.second, strategy.step))
-                return false;
-        }
+        // lookups would read through a null image, stop before the AI plays.
+        std::cerr << "can't load the AI database (res/gameaidatabase.dat), "
+                     "it's missing or invalid\n";
+        std::abort();
     }
-    return true;
+
+    assert(database.VerifyChecksum());
+    return database;
 }
 
-const GameAI::Database& GameAI::GetDatabse()
+Chessboard::PieceStep GameAI::PickStep(
+    const GameDatabase::StrategyRange& strategys,
+    int iq,
+    bool mirrored)
 {
-    static const Database kDatabase = LoadDatabase();
-    return kDatabase;
+    assert(strategys.first != strategys.second);
+    auto needle = static_cast<GameDatabase::U16Strategy>(iq << 8);
+    auto iter = std::lower_bound(strategys.first, strategys.second, needle);
+    auto strategy = (iter == strategys.second ? *(strategys.second - 1) : *iter);
+
+    Chessboard::PieceStep step = GameSolver::DeCompressStrategy(strategy).step;
+    return (mirrored ? Chessboard::MirrorStep(step) : step);
 }
+
+const GameDatabase& GameAI::GetDatabse()
+{
+    static const GameDatabase kDatabase = LoadDatabase();
+    return kDatabase;
+}
\ No newline at end of file
@@ -1,15 +1,26 @@
 ﻿#ifndef JIUGONGCHESS_GAMEAI_H
 #define JIUGONGCHESS_GAMEAI_H
 
-#include <vector>
-#include <cstdint>
-#include <unordered_map>
+#include <cstddef>
 #include "chessboard.h"
+#include "gamedatabase.h"
 
 class GameAI
 {
 public:
 
+    // levels of the game, as IQ presets.
+    enum class Level { Stupid, Mediocre, Invincible };
+    static const int kNumLevels = 3;
+
+    // a turn of any game, for handling turns of many games in a batch.
+    struct TurnRequest
+    {
+        Chessboard             chessboard;
+        Chessboard::PlayerSide role = Chessboard::PlayerSide::Sente;
+        int                    iq = 0;  // IQ of this turn, no random draw.
+    };
+
     GameAI(const GameAI&) = delete;
     explicit GameAI(Chessboard::PlayerSide role);
     ~GameAI();
@@ -17,17 +28,22 @@ public:
 
     static void Initialize();
     void SetIQ(int min, int max);
+    void SetLevel(Level level);
+
+    // uniform in [0, 1] picks the IQ of this turn, random if not given.
     Chessboard::PieceStep HandleGameTurn(const Chessboard& chessboard) const;
+    Chessboard::PieceStep HandleGameTurn(const Chessboard& chessboard, float uniform) const;
 
-private:
+    // handle turns in a tight loop, steps[i] is the step of requests[i].
+    static void HandleGameTurns(
+        const TurnRequest* requests, std::size_t num_requests, Chessboard::PieceStep* steps);
 
-    typedef std::uint32_t U32GameSituation;
-    typedef std::uint32_t U32Strategy;
-    typedef std::unordered_map<U32GameSituation, std::vector<U32Strategy>> Database;
+private:
 
-    static Database LoadDatabase();
-    static bool ValidateDatabase(const Database& database);
-    static const Database& GetDatabse();
+    static GameDatabase LoadDatabase();
+    static const GameDatabase& GetDatabse();
+    static Chessboard::PieceStep PickStep(
+        const GameDatabase::StrategyRange& strategys, int iq, bool mirrored);
 
     Chessboard::PlayerSide role_;
     int iq_min_ = 0;
@@ -0,0 +1,129 @@
+﻿#include "gameaibenchmark.h"
+#include <random>
+#include <ostream>
+#include <algorithm>
+#include "ashes/time.h"
+#include "jiugongchess.h"
+
+GameAIBenchmark::GameAIBenchmark(
+    std::size_t num_turns,
+    std::size_t batch_size,
+    int num_rounds,
+    std::uint32_t seed)
+    : num_turns_(num_turns)
+    , batch_size_((std::max)(batch_size, std::size_t(1)))
+    , num_rounds_((std::max)(num_rounds, 1))
+    , seed_(seed)
+{
+}
+
+GameAIBenchmark::~GameAIBenchmark()
+{
+}
+
+void GameAIBenchmark::Run()
+{
+    GameAI::Initialize();
+    SampleTurns();
+    result_ = Result();
+
+    std::vector<Chessboard::PieceStep> single_steps(turns_.size());
+    std::vector<Chessboard::PieceStep> batch_steps(turns_.size());
+    RunSingle(single_steps);
+    RunBatch(batch_steps);
+
+    result_.num_moves = static_cast<std::uint64_t>(turns_.size()) * num_rounds_;
+    for (std::size_t i = 0; i < turns_.size(); ++i)
+    {
+        result_.num_mismatches += (single_steps[i] == batch_steps[i] ? 0 : 1);
+    }
+}
+
+void GameAIBenchmark::PrintResult(std::ostream& os) const
+{
+    const double single_moves_per_sec = result_.single_seconds > 0.0
+        ? result_.num_moves / result_.single_seconds : 0.0;
+    const double batch_moves_per_sec = result_.batch_seconds > 0.0
+        ? result_.num_moves / result_.batch_seconds : 0.0;
+
+    os << "turns: " << turns_.size() << " x " << num_rounds_ << " rounds"
+       << ", batch size " << batch_size_ << ", seed " << seed_ << "\n";
+    os << "single: " << static_cast<std::uint64_t>(single_moves_per_sec) << " moves/sec\n";
+    os << "batch:  " << static_cast<std::uint64_t>(batch_moves_per_sec) << " moves/sec\n";
+    os << "mismatches: " << result_.num_mismatches << "\n";
+}
+
+const GameAIBenchmark::Result& GameAIBenchmark::GetResult() const
+{
+    return result_;
+}
+
+void GameAIBenchmark::SampleTurns()
+{
+    std::mt19937 engine(seed_);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    std::uniform_int_distribution<int> iqs(0, 29);
+
+    JiugongChess game;
+    GameAI sente_ai(Chessboard::PlayerSide::Sente);
+    GameAI gote_ai(Chessboard::PlayerSide::Gote);
+    sente_ai.SetLevel(GameAI::Level::Stupid);
+    gote_ai.SetLevel(GameAI::Level::Stupid);
+
+    // take every turn of games until enough.
+    turns_.clear();
+    while (turns_.size() < num_turns_)
+    {
+        if (game.GetGameState() != JiugongChess::GameState::UnderWay)
+        {
+            game.NewGame();
+        }
+
+        GameAI::TurnRequest turn;
+        turn.chessboard = game.GetChessboard();
+        turn.role = game.GetCurrentPlayer();
+        turn.iq = iqs(engine);
+        turns_.push_back(turn);
+
+        const GameAI& ai = (turn.role == Chessboard::PlayerSide::Sente ? sente_ai : gote_ai);
+        game.MovePiece(ai.HandleGameTurn(turn.chessboard, uniform(engine)));
+    }
+}
+
+void GameAIBenchmark::RunSingle(std::vector<Chessboard::PieceStep>& steps)
+{
+    GameAI sente_ai(Chessboard::PlayerSide::Sente);
+    GameAI gote_ai(Chessboard::PlayerSide::Gote);
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+
+    for (int round = 0; round < num_rounds_; ++round)
+    {
+        for (std::size_t i = 0; i < turns_.size(); ++i)
+        {
+            const GameAI::TurnRequest& turn = turns_[i];
+            GameAI& ai = (turn.role == Chessboard::PlayerSide::Sente ? sente_ai : gote_ai);
+            ai.SetIQ(turn.iq, turn.iq);
+            steps[i] = ai.HandleGameTurn(turn.chessboard);
+        }
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    result_.single_seconds = duration.count();
+}
+
+void GameAIBenchmark::RunBatch(std::vector<Chessboard::PieceStep>& steps)
+{
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+
+    for (int round = 0; round < num_rounds_; ++round)
+    {
+        for (std::size_t first = 0; first < turns_.size(); first += batch_size_)
+        {
+            const std::size_t num_turns = (std::min)(batch_size_, turns_.size() - first);
+            GameAI::HandleGameTurns(&turns_[first], num_turns, &steps[first]);
+        }
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    result_.batch_seconds = duration.count();
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+﻿#ifndef JIUGONGCHESS_GAMEAIBENCHMARK_H
+#define JIUGONGCHESS_GAMEAIBENCHMARK_H
+
+#include <iosfwd>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "gameai.h"
+
+//==============================================================================
+// GameAIBenchmark: throughput of GameAI in moves per second, handling turns
+// one at a time and in batches, on one thread.
+// turns are sampled from games of random play with random IQs, both ways
+// must pick the same steps for them.
+//==============================================================================
+
+class GameAIBenchmark
+{
+public:
+
+    struct Result
+    {
+        std::uint64_t num_moves = 0;        // of each way.
+        std::uint64_t num_mismatches = 0;   // steps differ between the ways.
+        double        single_seconds = 0.0;
+        double        batch_seconds = 0.0;
+    };
+
+    GameAIBenchmark(std::size_t num_turns, std::size_t batch_size,
+        int num_rounds, std::uint32_t seed = 0);
+    GameAIBenchmark(const GameAIBenchmark&) = delete;
+    ~GameAIBenchmark();
+    GameAIBenchmark& operator = (const GameAIBenchmark&) = delete;
+
+    void Run();
+    void PrintResult(std::ostream& os) const;
+    const Result& GetResult() const;
+
+private:
+
+    void SampleTurns();
+    void RunSingle(std::vector<Chessboard::PieceStep>& steps);
+    void RunBatch(std::vector<Chessboard::PieceStep>& steps);
+
+    const std::size_t   num_turns_;
+    const std::size_t   batch_size_;
+    const int           num_rounds_;  // turns are handled again in each round.
+    const std::uint32_t seed_;
+
+    std::vector<GameAI::TurnRequest> turns_;
+    Result                           result_;
+};
+
+#endif
\ No newline at end of file
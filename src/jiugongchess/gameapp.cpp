@@ -10,9 +10,9 @@
 using namespace std::chrono_literals;
 
 const std::vector<ashes::String> GameApp::kGameWindowTextsCN = {
-    TEXT("╔════╦═════╦═════╦═════╦══════════╗"),
-    TEXT("║  玩家  ║愚蠢的电脑║平庸的电脑║无敌的电脑║                    ║"),
-    TEXT("╠════╩═════╩═════╩═════╣   九    宫    棋   ║"),
+    TEXT("╔═══╦════╦════╦════╦═══╦══════════╗"),
+    TEXT("║ 玩家 ║愚蠢电脑║平庸电脑║无敌电脑║ 搜索 ║                    ║"),
+    TEXT("╠═══╩════╩════╩════╩═══╣   九    宫    棋   ║"),
     TEXT("║                                            ║                    ║"),
     TEXT("║  ┏━━┓        ┏━━┓        ┏━━┓  ║                    ║"),
     TEXT("║  ┃    ┃━━━━┃    ┃━━━━┃    ┃  ║   第  ９９９  回   ║"),
@@ -33,14 +33,14 @@ const std::vector<ashes::String> GameApp::kGameWindowTextsCN = {
     TEXT("║  ┃    ┃━━━━┃    ┃━━━━┃    ┃  ║                    ║"),
     TEXT("║  ┗━━┛        ┗━━┛        ┗━━┛  ╠══════════╣"),
     TEXT("║                                            ║                    ║"),
-    TEXT("╠════╦═════╦═════╦═════╣   切  换  语  言   ║"),
-    TEXT("║  玩家  ║愚蠢的电脑║平庸的电脑║无敌的电脑║                    ║"),
-    TEXT("╚════╩═════╩═════╩═════╩══════════╝")};
+    TEXT("╠═══╦════╦════╦════╦═══╣   切  换  语  言   ║"),
+    TEXT("║ 玩家 ║愚蠢电脑║平庸电脑║无敌电脑║ 搜索 ║                    ║"),
+    TEXT("╚═══╩════╩════╩════╩═══╩══════════╝")};
 
 const std::vector<ashes::String> GameApp::kGameWindowTextsEN = {
-    TEXT("╔════╦═════╦═════╦═════╦══════════╗"),
-    TEXT("║ Player ║ StupidAI ║MediocreAI║InvincibAI║                    ║"),
-    TEXT("╠════╩═════╩═════╩═════╣   JIUGONGCHESS     ║"),
+    TEXT("╔═══╦════╦════╦════╦═══╦══════════╗"),
+    TEXT("║Player║ Stupid ║Mediocre║Invincib║Search║                    ║"),
+    TEXT("╠═══╩════╩════╩════╩═══╣   JIUGONGCHESS     ║"),
     TEXT("║                                            ║                    ║"),
     TEXT("║  ┏━━┓        ┏━━┓        ┏━━┓  ║                    ║"),
     TEXT("║  ┃    ┃━━━━┃    ┃━━━━┃    ┃  ║ ROUND ９９９ GOING ║"),
@@ -61,9 +61,9 @@ const std::vector<ashes::String> GameApp::kGameWindowTextsEN = {
     TEXT("║  ┃    ┃━━━━┃    ┃━━━━┃    ┃  ║                    ║"),
     TEXT("║  ┗━━┛        ┗━━┛        ┗━━┛  ╠══════════╣"),
     TEXT("║                                            ║                    ║"),
-    TEXT("╠════╦═════╦═════╦═════╣  SWITCH  LANGUAGE  ║"),
-    TEXT("║ Player ║ StupidAI ║MediocreAI║InvincibAI║                    ║"),
-    TEXT("╚════╩═════╩═════╩═════╩══════════╝")};
+    TEXT("╠═══╦════╦════╦════╦═══╣  SWITCH  LANGUAGE  ║"),
+    TEXT("║Player║ Stupid ║Mediocre║Invincib║Search║                    ║"),
+    TEXT("╚═══╩════╩════╩════╩═══╩══════════╝")};
 
 const std::vector<ashes::String> GameApp::kGameGuideTextsCN = {
     TEXT("                    "),
@@ -99,10 +99,10 @@ const std::vector<ashes::Rect> GameApp::kChessboardGridRects = {
     {6, 19, 9, 20}, {22, 19, 25, 20}, {38, 19, 41, 20}};
 
 const std::vector<ashes::Rect> GameApp::kSenteRadioButtonRects = {
-    {2, 24, 9, 24}, {12, 24, 21, 24}, {24, 24, 33, 24}, {36, 24, 45, 24}};
+    {2, 24, 7, 24}, {10, 24, 17, 24}, {20, 24, 27, 24}, {30, 24, 37, 24}, {40, 24, 45, 24}};
     
 const std::vector<ashes::Rect> GameApp::kGoteRadioButtonRects = {
-    {2, 1, 9, 1}, {12, 1, 21, 1}, {24, 1, 33, 1}, {36, 1, 45, 1}};
+    {2, 1, 7, 1}, {10, 1, 17, 1}, {20, 1, 27, 1}, {30, 1, 37, 1}, {40, 1, 45, 1}};
     
 const std::vector<ashes::Rect> GameApp::kMenuItemRects = {
     {48, 10, 67, 12}, {48, 14, 67, 16}, 
@@ -149,9 +149,27 @@ void GameApp::OnInit()
     DrawGameGuide();
 
     // setup events. 
-    game_.OnNewTurn.Bind(this, &GameApp::DrawGameTurn);
-    activate_ai_timer_ = GetTimerManager().NewTimer2(
-        std::bind(&GameApp::OnActivateGameAI, this), 15ms, true);
+    game_.OnNewTurn.Bind(this, &GameApp::OnGameTurn);
+    ScheduleGameAI();
+}
+
+void GameApp::OnBenchmarkFrame()
+{
+    // database AIs play both sides, a step and a full draw per frame.
+    if (game_.GetGameState() != GameState::UnderWay)
+    {
+        game_.NewGame();
+    }
+    else
+    {
+        const bool is_sente = (game_.GetCurrentPlayer() == Chessboard::PlayerSide::Sente);
+        const GameAI& game_ai = (is_sente ? sente_ai_ : gote_ai_);
+        bool success = game_.MovePiece(game_ai.HandleGameTurn(game_.GetChessboard()));
+        assert(success);
+    }
+
+    in_game_guide_ = false;
+    DrawGameWindow();
 }
 
 void GameApp::DealMouseClickEvent()
@@ -315,7 +333,7 @@ void GameApp::PaintPieceOptionalMove(const ashes::Coord& coord, bool accent) con
     const WORD color = (accent ? GetGridColor(coord) : kBasicColor);
     const WORD fgcolor = ashes::graph::MakeFGColor(color);
 
-    std::vector<Chessboard::PieceStep> steps;
+    Chessboard::MoveList steps;
     game_.GetChessboard().GetOptionalMove(coord, steps);
 
     for (const Chessboard::PieceStep& step : steps)
@@ -373,25 +391,56 @@ void GameApp::DrawGameRoundsCounter() const
     ashes::GConsole().DrawString(text, kGameRoundsCounterRect, kBasicColor);
 }
 
-GameAI* GameApp::GetCurrentGameAI()
+bool GameApp::IsGameAITurn() const
 {
     if (game_.GetGameState() == GameState::UnderWay)
     {
         return game_.GetCurrentPlayer() == Chessboard::PlayerSide::Sente
-            ? (sente_type_ == PlayerType::Human ? nullptr : &sente_ai_)
-            : (gote_type_ == PlayerType::Human ? nullptr : &gote_ai_);
+            ? sente_type_ != PlayerType::Human
+            : gote_type_ != PlayerType::Human;
+    }
+    return false;
+}
+
+Chessboard::PieceStep GameApp::HandleGameAITurn()
+{
+    const Chessboard::PlayerSide player = game_.GetCurrentPlayer();
+    const bool is_sente = (player == Chessboard::PlayerSide::Sente);
+
+    if ((is_sente ? sente_type_ : gote_type_) == PlayerType::SearchAI)
+        return search_ai_.HandleGameTurn(game_.GetChessboard(), player);
+
+    const GameAI& game_ai = (is_sente ? sente_ai_ : gote_ai_);
+    return game_ai.HandleGameTurn(game_.GetChessboard());
+}
+
+void GameApp::ScheduleGameAI()
+{
+    // activate AI at next loop, so the current turn is showed first.
+    if (activate_ai_timer_ == nullptr && IsGameAITurn())
+    {
+        activate_ai_timer_ = GetTimerManager().NewTimer2(
+            std::bind(&GameApp::OnActivateGameAI, this), 15ms, false);
     }
-    return nullptr;
 }
 
 void GameApp::OnActivateGameAI()
 {
-    while (GameAI* ai = GetCurrentGameAI())
+    while (IsGameAITurn())
     {
-        Chessboard::PieceStep step = ai->HandleGameTurn(game_.GetChessboard());
+        Chessboard::PieceStep step = HandleGameAITurn();
         bool success = game_.MovePiece(step);
         assert(success);
     }
+
+    // the timer is killed after triggered, since it doesn't loop.
+    activate_ai_timer_ = nullptr;
+}
+
+void GameApp::OnGameTurn()
+{
+    DrawGameTurn();
+    ScheduleGameAI();
 }
 
 void GameApp::OnClickChessboard(const ashes::Coord& coord)
@@ -435,6 +484,7 @@ void GameApp::OnClickSenteRadioGroup(PlayerType item)
         PaintWidget({PanelID::SenteRadioGroup, sente_type_}, kBasicColor);
         PaintWidget({PanelID::SenteRadioGroup, item}, kSenteColor, kBasicColor);
         SetupGameAI(sente_ai_, sente_type_ = item);
+        ScheduleGameAI();
     }
 }
 
@@ -445,6 +495,7 @@ void GameApp::OnClickGoteRadioGroup(PlayerType item)
         PaintWidget({PanelID::GoteRadioGroup, gote_type_}, kBasicColor);
         PaintWidget({PanelID::GoteRadioGroup, item}, kGoteColor, kBasicColor);
         SetupGameAI(gote_ai_, gote_type_ = item);
+        ScheduleGameAI();
     }
 }
 
@@ -481,8 +532,12 @@ void GameApp::StartBlinkPiece()
 
 void GameApp::SetupGameAI(GameAI& game_ai, PlayerType type)
 {
-    static const int kIQMins[] = {0, 0,  2,  30};
-    static const int kIQMaxs[] = {0, 20, 22, 30};
-    int index = static_cast<int>(type);
-    game_ai.SetIQ(kIQMins[index], kIQMaxs[index]);
+    static const GameAI::Level kLevels[] = {
+        GameAI::Level::Stupid,  // human has no AI, any level is ok.
+        GameAI::Level::Stupid,
+        GameAI::Level::Mediocre,
+        GameAI::Level::Invincible,
+        GameAI::Level::Invincible,  // search AI has no database AI.
+    };
+    game_ai.SetLevel(kLevels[static_cast<int>(type)]);
 }
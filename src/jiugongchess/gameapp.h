@@ -7,6 +7,7 @@
 #include "ashes/graph.h"
 #include "ashes/consoleapp.h"
 #include "gameai.h"
+#include "searchai.h"
 #include "jiugongchess.h"
 
 class GameApp : public ashes::SimpleConsoleApp
@@ -24,6 +25,7 @@ protected:
     //==========================================================================
 
     void OnInit() override;
+    void OnBenchmarkFrame() override;
     void DealMouseClickEvent() override;
     WidgetID FindFocusWidget(const COORD& mouse_coord) const override;
     void OnMouseEnter(WidgetID widget) override;
@@ -39,7 +41,7 @@ private:
     typedef JiugongChess::GameState GameState;
 
     enum class PanelID { Null, Chessboard, SenteRadioGroup, GoteRadioGroup, Menu };
-    enum class PlayerType { Human, StupidAI, MediocreAI, InvincibleAI };
+    enum class PlayerType { Human, StupidAI, MediocreAI, InvincibleAI, SearchAI };
     enum class MenuItemID { SenteBackMove, GoteBackMove, NewGame, SwitchLanguage };
 
     struct BreakedWidgetID
@@ -114,8 +116,11 @@ private:
     // Event handling
     //==========================================================================
 
-    GameAI* GetCurrentGameAI();
+    bool IsGameAITurn() const;
+    Chessboard::PieceStep HandleGameAITurn();
+    void ScheduleGameAI();
     void OnActivateGameAI();
+    void OnGameTurn();
 
     void OnClickChessboard(const ashes::Coord& coord);
     void OnClickSenteRadioGroup(PlayerType item);
@@ -132,6 +137,7 @@ private:
     JiugongChess game_;
     GameAI       sente_ai_{Chessboard::PlayerSide::Sente};
     GameAI       gote_ai_{Chessboard::PlayerSide::Gote};
+    SearchAI     search_ai_{VariantBoard::Rules(), 16};  // for both players.
 
     ashes::Coord selected_piece_ = kInvalidPieceCoord;
     PlayerType   sente_type_ = PlayerType::Human;
@@ -0,0 +1,122 @@
+﻿#include "gamedatabase.h"
+#include <cassert>
+#include <cstring>
+#include "gamesolver.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+std::string GameDatabase::MakeImage(
+    const std::vector<std::vector<U16Strategy>>& strategys)
+{
+    std::vector<std::uint16_t> offsets(1, 0);
+    std::vector<U16Strategy> all_strategys;
+
+    for (const auto& row : strategys)
+    {
+        all_strategys.insert(all_strategys.end(), row.begin(), row.end());
+        assert(all_strategys.size() <= UINT16_MAX);
+        offsets.push_back(static_cast<std::uint16_t>(all_strategys.size()));
+    }
+
+    const std::size_t offsets_size = offsets.size() * sizeof(std::uint16_t);
+    const std::size_t strategys_size = all_strategys.size() * sizeof(U16Strategy);
+    std::string image(sizeof(Header) + offsets_size + strategys_size, '\0');
+    char* body = &image[sizeof(Header)];
+    std::memcpy(body, offsets.data(), offsets_size);
+    std::memcpy(body + offsets_size, all_strategys.data(), strategys_size);
+
+    Header header;
+    header.num_situations = static_cast<std::uint32_t>(strategys.size());
+    header.num_strategys = static_cast<std::uint32_t>(all_strategys.size());
+    header.checksum = Checksum(body, offsets_size + strategys_size);
+    std::memcpy(&image[0], &header, sizeof(Header));
+
+    return image;
+}
+
+bool GameDatabase::ValidateImage(const std::string& image)
+{
+    GameDatabase database;
+    if (!database.Attach(image.data(), image.size()) || !database.VerifyChecksum())
+        return false;
+
+    for (std::uint32_t rank = 0; rank < GameSolver::kNumSituationRanks; ++rank)
+    {
+        const auto situation = GameSolver::UnRankSituation(rank);
+        const StrategyRange range = database.GetStrategys(rank);
+
+        for (const U16Strategy* iter = range.first; iter != range.second; ++iter)
+        {
+            const auto strategy = GameSolver::DeCompressStrategy(*iter);
+            if (!situation.first.CanMovePiece(situation.second, strategy.step))
+                return false;
+
+            if (iter != range.first && *iter < *(iter - 1))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool GameDatabase::Attach(const void* image, std::size_t size)
+{
+    const Header* header = static_cast<const Header*>(image);
+    if (size < sizeof(Header)
+        || header->magic != kMagic
+        || header->version != kVersion
+        || header->num_situations != GameSolver::kNumSituationRanks)
+        return false;
+
+    const std::size_t num_offsets = header->num_situations + std::size_t(1);
+    const std::size_t body_size = (num_offsets + header->num_strategys) * sizeof(std::uint16_t);
+    if (size != sizeof(Header) + body_size)
+        return false;
+
+    const std::uint16_t* offsets = reinterpret_cast<const std::uint16_t*>(header + 1);
+    if (offsets[header->num_situations] != header->num_strategys)
+        return false;
+
+    header_ = header;
+    offsets_ = offsets;
+    strategys_ = offsets + num_offsets;
+    return true;
+}
+
+bool GameDatabase::VerifyChecksum() const
+{
+    assert(header_ != nullptr);
+    const std::size_t num_offsets = header_->num_situations + std::size_t(1);
+    const std::size_t body_size = (num_offsets + header_->num_strategys) * sizeof(std::uint16_t);
+    return Checksum(offsets_, body_size) == header_->checksum;
+}
+
+GameDatabase::StrategyRange GameDatabase::GetStrategys(std::uint32_t rank) const
+{
+    assert(header_ != nullptr && rank < header_->num_situations);
+    return {strategys_ + offsets_[rank], strategys_ + offsets_[rank + 1]};
+}
+
+void GameDatabase::PrefetchStrategys(std::uint32_t rank) const
+{
+    // the offsets are read first, strategys follow them in a lookup.
+    assert(header_ != nullptr && rank < header_->num_situations);
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    _mm_prefetch(reinterpret_cast<const char*>(offsets_ + rank), _MM_HINT_T0);
+#elif defined(__GNUC__)
+    __builtin_prefetch(offsets_ + rank);
+#endif
+}
+
+std::uint32_t GameDatabase::Checksum(const void* data, std::size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint32_t hash = 2166136261u;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+﻿#ifndef JIUGONGCHESS_GAMEDATABASE_H
+#define JIUGONGCHESS_GAMEDATABASE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+//==============================================================================
+// GameDatabase: strategys of all situations in a binary image, which is made
+// by GameSolver and used in place by GameAI.
+// image layout, in native byte order:
+//   Header
+//   std::uint16_t offsets[num_situations + 1]  strategys of situation ranked r
+//                                              are in [offsets[r], offsets[r+1]).
+//   std::uint16_t strategys[num_strategys]     compressed, sorted by score.
+// the image is validated when it is made, only its header is checked when it
+// is attached, so attaching takes constant time.
+//==============================================================================
+
+class GameDatabase
+{
+public:
+
+    typedef std::uint16_t U16Strategy;
+    typedef std::pair<const U16Strategy*, const U16Strategy*> StrategyRange;
+
+    static const std::uint32_t kMagic = 0x4244474A;  // "JGDB"
+    static const std::uint32_t kVersion = 2;  // 2: ranked by canonical situations.
+
+    struct Header
+    {
+        std::uint32_t magic = kMagic;
+        std::uint32_t version = kVersion;
+        std::uint32_t num_situations = 0;
+        std::uint32_t num_strategys = 0;
+        std::uint32_t checksum = 0;  // FNV-1a of offsets and strategys.
+    };
+
+    // Make & validate image, strategys are indexed by situation rank.
+    static std::string MakeImage(const std::vector<std::vector<U16Strategy>>& strategys);
+    static bool ValidateImage(const std::string& image);
+
+    // Use image in place, the image must outlive the database.
+    bool Attach(const void* image, std::size_t size);
+    bool VerifyChecksum() const;
+    StrategyRange GetStrategys(std::uint32_t rank) const;
+    void PrefetchStrategys(std::uint32_t rank) const;  // a hint to get them soon.
+
+private:
+
+    static std::uint32_t Checksum(const void* data, std::size_t size);
+
+    const Header*        header_ = nullptr;
+    const std::uint16_t* offsets_ = nullptr;
+    const U16Strategy*   strategys_ = nullptr;
+};
+
+#endif
\ No newline at end of file
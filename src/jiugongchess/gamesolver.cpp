@@ -1,117 +1,139 @@
 ﻿#include "gamesolver.h"
 #include <queue>
-#include <sstream>
 #include <cassert>
+#include <numeric>
 #include <algorithm>
 #include "ashes/math.h"
+#include "gamedatabase.h"
 
-//==============================================================================
-// GameSituation
-// Note: stable algorithm is important to keep result ordered! 
-//==============================================================================
-
-GameSituation::GameSituation(const Chessboard& c, Chessboard::PlayerSide p)
-    : chessboard_(c), player_(p)
-{
-    if (chessboard_.IsPlayerWin(Chessboard::EnemyOfPlayer(player_)))
-    {
-        type_ = Type::Failed;
-        end_steps_min_ = 0;
-        end_steps_max_ = 0;
-    }
-}
-
-GameSituation::~GameSituation()
-{
-}
+namespace {
 
-const Chessboard& GameSituation::GetChessboard() const
-{
-    return chessboard_;
-}
+const int kNumPieces = Chessboard::kNumPiecesEachPlayer;
+const int kNumGrids = Chessboard::kNumGrids;
 
-Chessboard::PlayerSide GameSituation::GetPlayer() const
+// binomial coefficient C(n, k) for n <= kNumGrids and k <= kNumPieces.
+int Binomial(int n, int k)
 {
-    return player_;
+    int value = 1;
+    for (int i = 1; i <= k; ++i) { value = value * (n - k + i) / i; }
+    return n < k ? 0 : value;
 }
 
-GameSituation::Type GameSituation::GetType() const
+// rank of a combination in colexicographic order: sum of C(index_i, i + 1)
+// for the i-th smallest set bit. ranks of k-bit masks are in [0, C(n, k)).
+int RankCombination(unsigned mask)
 {
-    return type_;
+    static const auto kRanks = []() {
+        std::array<std::uint8_t, Chessboard::kFullMask + 1> ranks = {};
+        for (unsigned m = 0; m < ranks.size(); ++m)
+        {
+            int rank = 0, k = 0;
+            for (int index = 0; index < kNumGrids; ++index)
+            {
+                if (m & (1 << index)) { rank += Binomial(index, ++k); }
+            }
+            ranks[m] = static_cast<std::uint8_t>(rank);
+        }
+        return ranks;
+    }();
+    return kRanks[mask];
 }
 
-auto GameSituation::GetSortedStrategys() const -> std::vector<Strategy>
+unsigned UnRankCombination(int rank, int k)
 {
-    std::vector<Strategy> strategys;
-
-    // fail links: the slower the better.
-    for (const Link& link : fail_links_)
+    unsigned mask = 0;
+    for (int n = kNumGrids - 1; k > 0; --n)
     {
-        int num_fail_steps = link.next->end_steps_min_;
-        int score = ashes::math::Clamp(num_fail_steps, 0, 9);
-        strategys.push_back({link.step, score});
+        if (Binomial(n, k) <= rank)
+        {
+            rank -= Binomial(n, k--);
+            mask |= 1 << n;
+        }
     }
+    return mask;
+}
 
-    // draw links: the enemy's mistake choice more the better.
-    for (const Link& link : draw_links_)
+// take bits of mask at set bits of select, and pack them to lowest bits.
+unsigned ExtractBits(unsigned mask, unsigned select)
+{
+    unsigned bits = 0;
+    for (int index = 0, k = 0; index < kNumGrids; ++index)
     {
-        int num_win_cases = static_cast<int>(link.next->fail_links_.size());
-        int score = 10 + ashes::math::Clamp(num_win_cases, 0, 9);
-        strategys.push_back({link.step, score});
+        if (select & (1 << index)) { bits |= ((mask >> index) & 1) << k++; }
     }
+    return bits;
+}
 
-    // win links: the faster the better.
-    for (const Link& link : win_links_)
+// inverse of ExtractBits.
+unsigned DepositBits(unsigned bits, unsigned select)
+{
+    unsigned mask = 0;
+    for (int index = 0, k = 0; index < kNumGrids; ++index)
     {
-        int num_win_steps = link.next->end_steps_max_;
-        int score = 29 - ashes::math::Clamp(num_win_steps, 0, 9);
-        strategys.push_back({link.step, score});
+        if (select & (1 << index)) { mask |= ((bits >> k++) & 1) << index; }
     }
-    
-    // sort by score.
-    std::stable_sort(strategys.begin(), strategys.end(),
-        [](const auto& a, const auto& b) { return a.score < b.score; });
-
-    return strategys;
+    return mask;
 }
 
-void GameSituation::AddLink(const Chessboard::PieceStep& step, GameSituation* next)
+// rank of a board by combinations of sente and gote piece grids.
+const int kNumGoteRanks = 20;                 // C(6,3)
+const int kNumBoardRanks = 84 * kNumGoteRanks;  // C(9,3)*C(6,3)
+
+int RankBoard(const Chessboard& chessboard)
 {
-    draw_links_.push_back({step, next});
+    const unsigned sente_mask = chessboard.GetPieceMask(Chessboard::PlayerSide::Sente);
+    const unsigned gote_mask = chessboard.GetPieceMask(Chessboard::PlayerSide::Gote);
+    const unsigned other_mask = Chessboard::kFullMask & ~sente_mask;
+
+    const int sente_rank = RankCombination(sente_mask);
+    const int gote_rank = RankCombination(ExtractBits(gote_mask, other_mask));
+    return sente_rank * kNumGoteRanks + gote_rank;
 }
 
-bool GameSituation::Update()
+Chessboard UnRankBoard(int board_rank)
 {
-    const Type type_copy = type_;
+    const unsigned sente_mask = UnRankCombination(board_rank / kNumGoteRanks, kNumPieces);
+    const unsigned other_mask = Chessboard::kFullMask & ~sente_mask;
+    const unsigned gote_bits = UnRankCombination(board_rank % kNumGoteRanks, kNumPieces);
+    const unsigned gote_mask = DepositBits(gote_bits, other_mask);
 
-    const auto pos = std::stable_partition(draw_links_.begin(), draw_links_.end(),
-        [](const Link& link) { return link.next->type_ == Type::Draw; });
-
-    if (pos != draw_links_.end())
+    Chessboard::GridStorage grids;
+    for (int index = 0; index < kNumGrids; ++index)
     {
-        for (auto iter = pos; iter != draw_links_.end(); ++iter)
-        {
-            const GameSituation& next = *iter->next;
-            end_steps_min_ = (std::min)(end_steps_min_, next.end_steps_min_ + 1);
-            end_steps_max_ = (std::max)(end_steps_max_, next.end_steps_max_ + 1);
-            (next.type_ == Type::Win ? fail_links_ : win_links_).push_back(*iter);
-        }
-        draw_links_.erase(pos, draw_links_.end());
+        grids[index] = (sente_mask & (1 << index)) ? Chessboard::GridType::SentePiece
+                     : (gote_mask & (1 << index))  ? Chessboard::GridType::GotePiece
+                     : Chessboard::GridType::Space;
     }
+    return Chessboard(grids);
+}
 
-    if (type_ == Type::Draw)
-    {
-        if (!win_links_.empty())
-        {
-            type_ = Type::Win;
-        }
-        else if (draw_links_.empty())
+// canonical boards are ranked by their order in all boards.
+struct CanonicalRanks
+{
+    std::vector<int> from_board_rank;  // -1 if the board is not canonical.
+    std::vector<int> to_board_rank;
+};
+
+const CanonicalRanks& GetCanonicalRanks()
+{
+    static const CanonicalRanks kRanks = []() {
+        CanonicalRanks ranks;
+        ranks.from_board_rank.assign(kNumBoardRanks, -1);
+        for (int board_rank = 0; board_rank < kNumBoardRanks; ++board_rank)
         {
-            type_ = Type::Fail;
+            Chessboard chessboard = UnRankBoard(board_rank);
+            if (!GameSolver::CanonicalizeChessboard(chessboard))
+            {
+                ranks.from_board_rank[board_rank] = static_cast<int>(ranks.to_board_rank.size());
+                ranks.to_board_rank.push_back(board_rank);
+            }
         }
-    }
+        assert(ranks.to_board_rank.size() * 2 == GameSolver::kNumSituationRanks);
+        return ranks;
+    }();
+    return kRanks;
+}
 
-    return type_ != type_copy;
 }
 
 //==============================================================================
@@ -128,7 +150,7 @@ std::uint16_t GameSolver::CompressStrategy(const GameSituation::Strategy& strate
 
 std::uint32_t GameSolver::CompressChessboard(const Chessboard& chessboard)
 {
-    const Chessboard::GridStorage& grids = chessboard.GetGridStorage();
+    const Chessboard::GridStorage grids = chessboard.GetGridStorage();
     std::uint32_t bits = 0;
     std::for_each(grids.rbegin(), grids.rend(), [&bits](Chessboard::GridType type) {
         bits = bits << 2 | static_cast<std::uint32_t>(type); });
@@ -169,92 +191,288 @@ std::pair<Chessboard, Chessboard::PlayerSide> GameSolver::DeCompressSituation(
     return {item1, item2};
 }
 
-GameSolver::GameSolver()
+bool GameSolver::CanonicalizeChessboard(Chessboard& chessboard)
 {
+    const Chessboard mirror = chessboard.GetMirror();
+    const auto key = std::make_pair(
+        chessboard.GetPieceMask(Chessboard::PlayerSide::Sente),
+        chessboard.GetPieceMask(Chessboard::PlayerSide::Gote));
+    const auto mirror_key = std::make_pair(
+        mirror.GetPieceMask(Chessboard::PlayerSide::Sente),
+        mirror.GetPieceMask(Chessboard::PlayerSide::Gote));
+
+    if (key <= mirror_key)
+        return false;
+
+    chessboard = mirror;
+    return true;
 }
 
-GameSolver::~GameSolver()
+std::uint32_t GameSolver::RankSituation(
+    const Chessboard& chessboard,
+    Chessboard::PlayerSide player)
 {
+    const int canonical_rank = GetCanonicalRanks().from_board_rank[RankBoard(chessboard)];
+    assert(canonical_rank >= 0);
+    return static_cast<std::uint32_t>(canonical_rank * 2 + static_cast<int>(player));
 }
 
-void GameSolver::Print(std::ostream& os) const
+std::pair<Chessboard, Chessboard::PlayerSide> GameSolver::UnRankSituation(
+    std::uint32_t rank)
 {
-    for (const auto& item : situations_)
-    {
-        if (item.second.GetType() == GameSituation::Type::Failed)
-            continue;
+    assert(rank < kNumSituationRanks);
+    const int board_rank = GetCanonicalRanks().to_board_rank[rank / 2];
+    return {UnRankBoard(board_rank), static_cast<Chessboard::PlayerSide>(rank % 2)};
+}
 
-        const auto strategys = item.second.GetSortedStrategys();
-        os << "\n" << item.first << " " << strategys.size();
+GameSolver::GameSolver()
+{
+}
 
-        for (const GameSituation::Strategy& strategy : strategys)
-        {
-            os << " " << CompressStrategy(strategy);
-        }
-    }
+GameSolver::~GameSolver()
+{
 }
 
 void GameSolver::BruteForceSolve()
 {
     BruteForceSearch();
-    BruteForceUpdate();
+    RetrogradeUpdate();
 }
 
-std::pair<GameSituation*, bool> GameSolver::FindOrAddSituation(
-    const Chessboard& chessboard,
-    Chessboard::PlayerSide player)
+std::string GameSolver::MakeDatabaseImage() const
 {
-    const std::uint32_t key = CompressSituation(chessboard, player);
-    auto iter = situations_.find(key);
-    bool existed = (iter != situations_.end());
+    std::vector<std::vector<GameDatabase::U16Strategy>> strategys(kNumSituationRanks);
 
-    if (!existed)
+    for (SituationIndex index = 0; index < kNumSituationRanks; ++index)
     {
-        GameSituation situation(chessboard, player);
-        iter = situations_.emplace(key, std::move(situation)).first;
+        if (!is_reachables_[index] || GetType(index) == GameSituation::Type::Failed)
+            continue;
+
+        for (const GameSituation::Strategy& strategy : GetSortedStrategys(index))
+        {
+            strategys[index].push_back(CompressStrategy(strategy));
+        }
     }
 
-    return {&iter->second, !existed};
+    return GameDatabase::MakeImage(strategys);
 }
 
 void GameSolver::BruteForceSearch()
 {
-    situations_.clear();
-    FindOrAddSituation(Chessboard(), Chessboard::PlayerSide::Sente);
-    std::queue<GameSituation*> open_queue;
-    open_queue.push(&situations_.begin()->second);
+    static_assert(kNumSituationRanks <= UINT16_MAX, "situation index is 16 bits.");
+    is_reachables_.assign(kNumSituationRanks, false);
+    types_.assign(kNumSituationRanks, static_cast<std::uint8_t>(GameSituation::Type::Draw));
+    end_steps_.assign(kNumSituationRanks, 0);
+    num_draw_links_.assign(kNumSituationRanks, 0);
+
+    // search out situations reachable from the initial one.
+    Chessboard initial_chessboard;
+    CanonicalizeChessboard(initial_chessboard);
+    const auto initial_index = static_cast<SituationIndex>(
+        RankSituation(initial_chessboard, Chessboard::PlayerSide::Sente));
+    std::queue<SituationIndex> open_queue;
+    open_queue.push(initial_index);
+    is_reachables_[initial_index] = true;
 
     while (!open_queue.empty())
     {
-        GameSituation* cur = open_queue.front();
+        const SituationIndex cur = open_queue.front();
         open_queue.pop();
-        if (cur->GetType() == GameSituation::Type::Failed)
+        const auto situation = UnRankSituation(cur);
+        if (situation.first.IsPlayerWin(Chessboard::EnemyOfPlayer(situation.second)))
+        {
+            types_[cur] = static_cast<std::uint8_t>(GameSituation::Type::Failed);
             continue;
+        }
+
+        const auto next_player = Chessboard::EnemyOfPlayer(situation.second);
+        situation.first.ForEachOptionalMove(situation.second,
+            [&](const Chessboard::PieceStep& step) {
+            Chessboard next_chessboard = situation.first;
+            next_chessboard.MovePiece(step);
+            CanonicalizeChessboard(next_chessboard);
+            const auto next = static_cast<SituationIndex>(
+                RankSituation(next_chessboard, next_player));
+            if (!is_reachables_[next])
+            {
+                is_reachables_[next] = true;
+                open_queue.push(next);
+            }
+        });
+    }
+
+    // link situations in order of indexes.
+    link_offsets_.assign(1, 0);
+    link_steps_.clear();
+    link_nexts_.clear();
+    for (SituationIndex index = 0; index < kNumSituationRanks; ++index)
+    {
+        AddLinks(index);
+    }
+
+    AddPrevSituations();
+}
+
+void GameSolver::RetrogradeUpdate()
+{
+    std::queue<SituationIndex> solved_queue;
+
+    for (SituationIndex index = 0; index < kNumSituationRanks; ++index)
+    {
+        if (StartUpdate(index)) { solved_queue.push(index); }
+    }
 
-        const auto next_player = Chessboard::EnemyOfPlayer(cur->GetPlayer());
-        std::vector<Chessboard::PieceStep> steps;
-        cur->GetChessboard().GetOptionalMove(cur->GetPlayer(), steps);
+    while (!solved_queue.empty())
+    {
+        const SituationIndex cur = solved_queue.front();
+        solved_queue.pop();
 
-        for (const Chessboard::PieceStep& step : steps)
+        for (std::uint32_t i = prev_offsets_[cur]; i < prev_offsets_[cur + 1]; ++i)
         {
-            Chessboard next_chessboard = cur->GetChessboard();
+            const SituationIndex prev = prev_situations_[i];
+            if (Update(prev, cur)) { solved_queue.push(prev); }
+        }
+    }
+}
+
+void GameSolver::AddLinks(SituationIndex index)
+{
+    if (is_reachables_[index] && GetType(index) != GameSituation::Type::Failed)
+    {
+        const auto situation = UnRankSituation(index);
+        const auto next_player = Chessboard::EnemyOfPlayer(situation.second);
+        situation.first.ForEachOptionalMove(situation.second,
+            [&](const Chessboard::PieceStep& step) {
+            Chessboard next_chessboard = situation.first;
             next_chessboard.MovePiece(step);
-            auto ret = FindOrAddSituation(next_chessboard, next_player);
-            if (ret.second) { open_queue.push(ret.first); }
-            cur->AddLink(step, ret.first);
+            CanonicalizeChessboard(next_chessboard);
+
+            const int piece_index = Chessboard::CoordToIndex(step.first);
+            const int space_index = Chessboard::CoordToIndex(step.second);
+            link_steps_.push_back(static_cast<std::uint8_t>(piece_index << 4 | space_index));
+            link_nexts_.push_back(static_cast<SituationIndex>(
+                RankSituation(next_chessboard, next_player)));
+        });
+
+        const std::size_t num_links = link_nexts_.size() - link_offsets_.back();
+        static_assert(Chessboard::kNumMaxMoves <= UINT8_MAX, "draw links are 8 bits.");
+        num_draw_links_[index] = static_cast<std::uint8_t>(num_links);
+    }
+
+    link_offsets_.push_back(static_cast<std::uint32_t>(link_nexts_.size()));
+}
+
+void GameSolver::AddPrevSituations()
+{
+    // count links to each situation, then place links by the counts.
+    prev_offsets_.assign(kNumSituationRanks + 1, 0);
+    for (SituationIndex next : link_nexts_) { ++prev_offsets_[next + 1]; }
+    std::partial_sum(prev_offsets_.begin(), prev_offsets_.end(), prev_offsets_.begin());
+
+    std::vector<std::uint32_t> prev_ends(prev_offsets_.begin(), prev_offsets_.end() - 1);
+    prev_situations_.resize(link_nexts_.size());
+    for (SituationIndex index = 0; index < kNumSituationRanks; ++index)
+    {
+        for (std::uint32_t i = link_offsets_[index]; i < link_offsets_[index + 1]; ++i)
+        {
+            prev_situations_[prev_ends[link_nexts_[i]]++] = index;
         }
     }
 }
 
-void GameSolver::BruteForceUpdate()
+bool GameSolver::StartUpdate(SituationIndex index)
+{
+    if (!is_reachables_[index])
+        return false;
+
+    // no piece can move, the same as failed at time.
+    if (GetType(index) == GameSituation::Type::Draw
+        && link_offsets_[index] == link_offsets_[index + 1])
+    {
+        types_[index] = static_cast<std::uint8_t>(GameSituation::Type::Fail);
+    }
+
+    return GetType(index) != GameSituation::Type::Draw;
+}
+
+bool GameSolver::Update(SituationIndex index, SituationIndex solved_next)
+{
+    const GameSituation::Type next_type = GetType(solved_next);
+    assert(next_type != GameSituation::Type::Draw);
+    if (GetType(index) != GameSituation::Type::Draw)
+        return false;
+
+    if (next_type == GameSituation::Type::Win)
+    {
+        assert(num_draw_links_[index] > 0);
+        if (--num_draw_links_[index] > 0)
+            return false;
+
+        types_[index] = static_cast<std::uint8_t>(GameSituation::Type::Fail);
+    }
+    else
+    {
+        types_[index] = static_cast<std::uint8_t>(GameSituation::Type::Win);
+    }
+
+    // situations are solved in order of end steps, so the first <fail> next
+    // is the fastest win, and the last <win> next is the slowest fail.
+    assert(end_steps_[solved_next] < UINT8_MAX);
+    end_steps_[index] = static_cast<std::uint8_t>(end_steps_[solved_next] + 1);
+    return true;
+}
+
+int GameSolver::CountLinks(SituationIndex index, GameSituation::Type next_type) const
+{
+    int count = 0;
+    for (std::uint32_t i = link_offsets_[index]; i < link_offsets_[index + 1]; ++i)
+    {
+        count += (GetType(link_nexts_[i]) == next_type ? 1 : 0);
+    }
+    return count;
+}
+
+GameSituation::Type GameSolver::GetType(SituationIndex index) const
+{
+    return static_cast<GameSituation::Type>(types_[index]);
+}
+
+std::vector<GameSituation::Strategy> GameSolver::GetSortedStrategys(
+    SituationIndex index) const
 {
-    for (bool has_update = true; has_update; )
+    std::vector<GameSituation::Strategy> strategys;
+
+    for (std::uint32_t i = link_offsets_[index]; i < link_offsets_[index + 1]; ++i)
     {
-        has_update = false;
+        const SituationIndex next = link_nexts_[i];
+        const GameSituation::Type next_type = GetType(next);
+        int score = 0;
 
-        for (auto& item : situations_)
+        if (next_type == GameSituation::Type::Win)
+        {
+            // fail links: the slower the better.
+            score = ashes::math::Clamp<int>(end_steps_[next], 0, 9);
+        }
+        else if (next_type == GameSituation::Type::Draw)
         {
-            has_update |= item.second.Update();
+            // draw links: the enemy's mistake choice more the better.
+            score = 10 + ashes::math::Clamp(CountLinks(next, GameSituation::Type::Win), 0, 9);
         }
+        else
+        {
+            // win links: the faster the better.
+            score = 29 - ashes::math::Clamp<int>(end_steps_[next], 0, 9);
+        }
+
+        const Chessboard::PieceStep step = {
+            Chessboard::IndexToCoord(link_steps_[i] >> 4),
+            Chessboard::IndexToCoord(link_steps_[i] & 0xF)};
+        strategys.push_back({step, score});
     }
+
+    // sort by score, stable algorithm is important to keep result ordered!
+    std::stable_sort(strategys.begin(), strategys.end(),
+        [](const auto& a, const auto& b) { return a.score < b.score; });
+
+    return strategys;
 }
\ No newline at end of file
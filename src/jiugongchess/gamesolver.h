@@ -1,14 +1,14 @@
 ﻿#ifndef JIUGONGCHESS_GAMESOLVER_H
 #define JIUGONGCHESS_GAMESOLVER_H
 
-#include <map>
-#include <iosfwd>
+#include <string>
 #include <vector>
 #include <cstdint>
 #include "chessboard.h"
 
 //==============================================================================
-// GameSituation
+// GameSituation: result types of a situation, a situation is a chessboard and
+// the player to move. nodes of situations are kept by GameSolver.
 //==============================================================================
 
 class GameSituation
@@ -23,61 +23,29 @@ public:
         Failed,  // current player is already fail at time.
     };
 
-    struct Link
-    {
-        Chessboard::PieceStep step;            // if make the piece move,
-        GameSituation*        next = nullptr;  // will get the situation.
-    };
-
     struct Strategy
     {
         Chessboard::PieceStep step;       // the better the piece move is,
         int                   score = 0;  // the bigger the score get.
     };
-
-public:
-
-    // Special functions: uncopyable but moveable.
-    GameSituation(const GameSituation&) = delete;
-    GameSituation(GameSituation&&) = default;
-    GameSituation(const Chessboard& chessboard, Chessboard::PlayerSide player);
-    ~GameSituation();
-    GameSituation& operator = (const GameSituation&) = delete;
-    GameSituation& operator = (GameSituation&&) = default;
-
-    // Basic infos.
-    const Chessboard& GetChessboard() const;
-    Chessboard::PlayerSide GetPlayer() const;
-    Type GetType() const;
-
-    // Situation link.
-    std::vector<Strategy> GetSortedStrategys() const;
-    void AddLink(const Chessboard::PieceStep& step, GameSituation* next);
-    bool Update();
-
-private:
-
-    const Chessboard             chessboard_;
-    const Chessboard::PlayerSide player_;
-
-    Type type_ = Type::Draw;            // situation type after last update.
-    int  end_steps_min_ = INT_MAX - 1;  // minimum number of win/fail steps.
-    int  end_steps_max_ = INT_MIN + 1;  // maximum number of win/fail steps.
-
-    std::vector<Link> win_links_;   // let we go to a win situation.
-    std::vector<Link> draw_links_;  // let we go to a draw situation.
-    std::vector<Link> fail_links_;  // let we go to a fail situation.
 };
 
 
 //==============================================================================
 // GameSolver
-// 1.brute-force search out all situations, build a situation graph.
+// 1.brute-force search out all situations, build a situation graph with links
+//   to next situations and back to previous situations. a situation and its
+//   left-right mirror are the same node, indexed by the situation rank.
 //   at this time, only <failed> situation is solved, all others are temporarily 
 //   regarded as <draw>.
-// 2.update unsolved situations by their next situations, a <draw> situation
-//   could be update to <win> or <fail>. if no situation can be update, then 
-//   all situations is solved. 
+// 2.retrograde update from solved situations through a work queue: when a
+//   situation is solved, its previous situations are updated by it. a <draw>
+//   situation is solved as <win> once a next situation is <fail>/<failed>, or
+//   as <fail> once all next situations are <win>. each link is updated once,
+//   situations still <draw> after the queue is empty are real <draw>.
+// the graph is in compressed sparse rows: links of situation i are entries
+// [link_offsets_[i], link_offsets_[i + 1]) of the link arrays, and so are
+// previous situations. types, end steps and counters are parallel arrays.
 //==============================================================================
 
 class GameSolver
@@ -96,25 +64,54 @@ public:
     static std::pair<Chessboard, Chessboard::PlayerSide> DeCompressSituation(
         std::uint32_t bits);
 
+    // Canonicalize chessboard under left-right mirror, return true if mirrored.
+    // situations are solved, stored and looked up by canonical chessboards.
+    static bool CanonicalizeChessboard(Chessboard& chessboard);
+
+    // Rank canonical situation to a dense index in [0, kNumSituationRanks),
+    // and back. 858 of C(9,3)*C(6,3) = 1680 chessboards are canonical.
+    static const std::uint32_t kNumSituationRanks = 858 * 2;
+    static std::uint32_t RankSituation(
+        const Chessboard& chessboard, Chessboard::PlayerSide player);
+    static std::pair<Chessboard, Chessboard::PlayerSide> UnRankSituation(
+        std::uint32_t rank);
+
     // Special functions.
     GameSolver();
     GameSolver(const GameSolver&) = delete;
     ~GameSolver();
     GameSolver& operator = (const GameSolver&) = delete;
 
-    // Solve & Print
-    void Print(std::ostream& os) const;
+    // Solve & Make database image
     void BruteForceSolve();
+    std::string MakeDatabaseImage() const;
 
 private:
 
-    std::pair<GameSituation*, bool> FindOrAddSituation(
-        const Chessboard& chessboard, Chessboard::PlayerSide player);
+    typedef std::uint16_t SituationIndex;  // situation rank.
 
     void BruteForceSearch();
-    void BruteForceUpdate();
-
-    std::map<std::uint32_t, GameSituation> situations_;
+    void RetrogradeUpdate();
+
+    // Situation graph.
+    void AddLinks(SituationIndex index);
+    void AddPrevSituations();
+    bool StartUpdate(SituationIndex index);
+    bool Update(SituationIndex index, SituationIndex solved_next);
+    int CountLinks(SituationIndex index, GameSituation::Type next_type) const;
+    GameSituation::Type GetType(SituationIndex index) const;
+    std::vector<GameSituation::Strategy> GetSortedStrategys(SituationIndex index) const;
+
+    std::vector<bool>           is_reachables_;   // situations searched out.
+    std::vector<std::uint8_t>   types_;           // situation types.
+    std::vector<std::uint8_t>   end_steps_;       // number of win/fail steps if both play best.
+    std::vector<std::uint8_t>   num_draw_links_;  // number of links to unsolved or <win> situations.
+
+    std::vector<std::uint32_t>  link_offsets_;    // links in order of optional moves.
+    std::vector<std::uint8_t>   link_steps_;      // piece index << 4 | space index.
+    std::vector<SituationIndex> link_nexts_;
+    std::vector<std::uint32_t>  prev_offsets_;    // situations linking to this one.
+    std::vector<SituationIndex> prev_situations_;
 };
 
 #endif
\ No newline at end of file
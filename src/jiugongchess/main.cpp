@@ -1,17 +1,161 @@
-﻿#include <fstream>
+﻿#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include "ashes/console.h"
 #include "gameapp.h"
+#include "gameaibenchmark.h"
+#include "gamedatabase.h"
 #include "gamesolver.h"
+#include "searchai.h"
+#include "tournament.h"
+#include "variantsolver.h"
+#include "variantdisksolver.h"
 
 void RunGameSolver()
 {
     GameSolver solver;
     solver.BruteForceSolve();
-    std::ofstream ofs("res\\gameaidatabase.dat");
-    solver.Print(ofs);
+    const std::string image = solver.MakeDatabaseImage();
+    if (!GameDatabase::ValidateImage(image))
+        return;
+
+    std::ofstream ofs("res\\gameaidatabase.dat", std::ios::binary);
+    ofs.write(image.data(), image.size());
+}
+
+// parse rules from: <rows> <cols> <pieces> [orthogonal|alquerque|king]
+bool ParseVariantRules(int argc, char* argv[], VariantBoard::Rules& rules)
+{
+    if (argc < 3)
+        return false;
+
+    rules.num_rows = std::atoi(argv[0]);
+    rules.num_cols = std::atoi(argv[1]);
+    rules.num_pieces = std::atoi(argv[2]);
+
+    const char* connectivity = (argc > 3 ? argv[3] : "alquerque");
+    rules.connectivity = (std::strcmp(connectivity, "orthogonal") == 0
+        ? VariantBoard::Connectivity::Orthogonal
+        : std::strcmp(connectivity, "king") == 0
+        ? VariantBoard::Connectivity::King
+        : VariantBoard::Connectivity::Alquerque);
+
+    if (!VariantBoard::ValidateRules(rules))
+    {
+        std::cerr << (VariantBoard::HasTooManyStates(rules)
+            ? "too many states\n" : "invalid variant rules\n");
+        return false;
+    }
+    return true;
+}
+
+// usage: --solve-variant <rules> [threads]
+//        --solve-variant-on-disk <file> <rules>
+//        --search-variant <rules> [msecs]
+bool RunVariantSolver(int argc, char* argv[])
+{
+    VariantBoard::Rules rules;
+
+    if (argc >= 5 && std::strcmp(argv[1], "--solve-variant") == 0)
+    {
+        if (ParseVariantRules(argc - 2, argv + 2, rules))
+        {
+            const int num_threads = (argc > 6 ? std::atoi(argv[6]) : 0);
+            VariantSolver solver(rules, num_threads);
+            solver.Solve();
+            solver.PrintStats(std::cout);
+        }
+        return true;
+    }
+
+    if (argc >= 6 && std::strcmp(argv[1], "--solve-variant-on-disk") == 0)
+    {
+        if (ParseVariantRules(argc - 3, argv + 3, rules))
+        {
+            VariantDiskSolver solver(rules, argv[2]);
+            if (solver.Solve())
+            {
+                solver.PrintStats(std::cout);
+            }
+            else
+            {
+                std::cerr << "can't map file " << argv[2] << "\n";
+            }
+        }
+        return true;
+    }
+
+    if (argc >= 5 && std::strcmp(argv[1], "--search-variant") == 0)
+    {
+        if (ParseVariantRules(argc - 2, argv + 2, rules))
+        {
+            SearchAI search_ai(rules);
+            search_ai.SetTimeBudget(ashes::time::Msecs(argc > 6 ? std::atoi(argv[6]) : 1000));
+            search_ai.Search(search_ai.GetBoard().GetInitialState());
+            search_ai.PrintStats(std::cout);
+        }
+        return true;
+    }
+
+    return false;
 }
 
-int main()
+// usage: --tournament [games] [threads] [seed]
+bool RunTournament(int argc, char* argv[])
 {
+    if (argc < 2 || std::strcmp(argv[1], "--tournament") != 0)
+        return false;
+
+    const std::uint64_t num_games = (argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000);
+    const int num_threads = (argc > 3 ? std::atoi(argv[3]) : 0);
+    const auto seed = static_cast<std::uint32_t>(argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0);
+
+    Tournament tournament(num_games, num_threads, seed);
+    tournament.Run();
+    tournament.PrintResults(std::cout);
+    return true;
+}
+
+// usage: --benchmark-ai [turns] [batch] [rounds]
+bool RunGameAIBenchmark(int argc, char* argv[])
+{
+    if (argc < 2 || std::strcmp(argv[1], "--benchmark-ai") != 0)
+        return false;
+
+    const std::size_t num_turns = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100000);
+    const std::size_t batch_size = (argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 256);
+    const int num_rounds = (argc > 4 ? std::atoi(argv[4]) : 100);
+
+    GameAIBenchmark benchmark(num_turns, batch_size, num_rounds);
+    benchmark.Run();
+    benchmark.PrintResult(std::cout);
+    return true;
+}
+
+// usage: --benchmark-render [frames]
+bool RunRenderBenchmark(int argc, char* argv[])
+{
+    if (argc < 2 || std::strcmp(argv[1], "--benchmark-render") != 0)
+        return false;
+
+    const std::size_t num_frames = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 10000);
+
+    // draw headless, AI turns are taken by frames instead of timers.
+    ashes::Console::SetBackend(ashes::ConsoleBackend::MakeNullBackend({80, 25}));
+    GameApp ui;
+    ui.RunRenderBenchmark(num_frames, std::cout);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (RunVariantSolver(argc, argv)
+        || RunTournament(argc, argv)
+        || RunGameAIBenchmark(argc, argv)
+        || RunRenderBenchmark(argc, argv))
+        return 0;
+
     GameApp ui;
     ui.Run();
     return 0;
@@ -0,0 +1,292 @@
+﻿#include "searchai.h"
+#include <random>
+#include <cassert>
+#include <cstdlib>
+#include <ostream>
+#include <algorithm>
+
+namespace {
+
+const int kInfinity = SearchAI::kWinScore + 1;
+const std::uint64_t kNodesPerTimeCheck = 1024;
+
+// scores of wins are kept in the table by distance from the state, not from
+// the root, so they are right wherever the state is met again.
+bool IsWinScore(int score)
+{
+    return std::abs(score) >= SearchAI::kWinScore - SearchAI::kMaxDepth;
+}
+
+int ToTableScore(int score, int ply)
+{
+    return IsWinScore(score) ? (score > 0 ? score + ply : score - ply) : score;
+}
+
+int FromTableScore(int score, int ply)
+{
+    return IsWinScore(score) ? (score > 0 ? score - ply : score + ply) : score;
+}
+
+}
+
+SearchAI::SearchAI(const VariantBoard::Rules& rules, int table_bits)
+    : board_(rules)
+    , piece_keys_(2 * VariantBoard::kMaxNumCells)
+    , table_(std::size_t(1) << table_bits)
+{
+    std::mt19937_64 engine(0x4A47534541524348ull);  // fixed, for same searches.
+    std::generate(piece_keys_.begin(), piece_keys_.end(), std::ref(engine));
+    player_key_ = engine();
+}
+
+SearchAI::~SearchAI()
+{
+}
+
+void SearchAI::SetTimeBudget(ashes::time::Msecs budget)
+{
+    time_budget_ = budget;
+}
+
+void SearchAI::SetMaxDepth(int depth)
+{
+    assert(0 < depth && depth <= kMaxDepth);
+    max_depth_ = depth;
+}
+
+auto SearchAI::Search(const State& state) -> State
+{
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+    deadline_ = start_time + time_budget_;
+    is_time_out_ = false;
+    stats_ = Stats();
+    child_stacks_.resize(max_depth_ + 1);
+
+    std::vector<Child> roots;
+    MakeChildren(state, HashState(state), -1, roots);
+    assert(!roots.empty());
+
+    // deepen until time out, the best move of a finished iteration is kept,
+    // and searched first in the next one.
+    for (int depth = 1; depth <= max_depth_; ++depth)
+    {
+        int alpha = -kInfinity;
+        std::size_t best_index = 0;
+
+        for (std::size_t i = 0; i < roots.size(); ++i)
+        {
+            const int score = -NegaMax(roots[i].state, roots[i].key, depth - 1, 1, -kInfinity, -alpha);
+            if (is_time_out_)
+                break;
+
+            if (score > alpha)
+            {
+                alpha = score;
+                best_index = i;
+            }
+        }
+
+        if (is_time_out_)
+            break;
+
+        std::rotate(roots.begin(), roots.begin() + best_index, roots.begin() + best_index + 1);
+        stats_.depth = depth;
+        stats_.score = alpha;
+
+        // a win or fail is proved, deeper search won't change it.
+        if (IsWinScore(alpha))
+            break;
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    stats_.seconds = duration.count();
+    return roots.front().state;
+}
+
+Chessboard::PieceStep SearchAI::HandleGameTurn(
+    const Chessboard& chessboard,
+    Chessboard::PlayerSide player)
+{
+    assert(board_.GetRules().num_rows == Chessboard::kNumRows
+        && board_.GetRules().num_cols == Chessboard::kNumCols
+        && board_.GetRules().num_pieces == Chessboard::kNumPiecesEachPlayer
+        && board_.GetRules().connectivity == VariantBoard::Connectivity::Alquerque);
+
+    // cells of the default variant are indexed the same as grids.
+    State state;
+    state.sente_mask = chessboard.GetPieceMask(Chessboard::PlayerSide::Sente);
+    state.gote_mask = chessboard.GetPieceMask(Chessboard::PlayerSide::Gote);
+    state.player = player;
+
+    const State next = Search(state);
+    const VariantBoard::CellMask piece_mask = VariantBoard::GetPieceMask(state, player);
+    const VariantBoard::CellMask next_mask = VariantBoard::GetPieceMask(next, player);
+    const Chessboard::PieceStep step = {
+        Chessboard::IndexToCoord(VariantBoard::LowestCell(piece_mask & ~next_mask)),
+        Chessboard::IndexToCoord(VariantBoard::LowestCell(next_mask & ~piece_mask))};
+    assert(chessboard.CanMovePiece(player, step));
+    return step;
+}
+
+const VariantBoard& SearchAI::GetBoard() const
+{
+    return board_;
+}
+
+auto SearchAI::GetStats() const -> const Stats&
+{
+    return stats_;
+}
+
+void SearchAI::PrintStats(std::ostream& os) const
+{
+    const double nodes_per_sec = stats_.seconds > 0.0 ? stats_.num_nodes / stats_.seconds : 0.0;
+    os << "depth: " << stats_.depth << ", score " << stats_.score << "\n";
+    os << "nodes: " << stats_.num_nodes
+       << " in " << stats_.seconds << " s"
+       << ", " << static_cast<std::uint64_t>(nodes_per_sec) << " nodes/sec\n";
+}
+
+std::uint64_t SearchAI::HashState(const State& state) const
+{
+    std::uint64_t key = (state.player == Chessboard::PlayerSide::Gote ? player_key_ : 0);
+    for (VariantBoard::CellMask pieces = state.sente_mask; pieces != 0; pieces &= pieces - 1)
+    {
+        key ^= piece_keys_[VariantBoard::LowestCell(pieces)];
+    }
+    for (VariantBoard::CellMask pieces = state.gote_mask; pieces != 0; pieces &= pieces - 1)
+    {
+        key ^= piece_keys_[VariantBoard::kMaxNumCells + VariantBoard::LowestCell(pieces)];
+    }
+    return key;
+}
+
+std::uint64_t SearchAI::HashStep(const State& state, const State& next) const
+{
+    // a step flips the player to move, and a piece of the mover from and to.
+    const Chessboard::PlayerSide mover = state.player;
+    const int offset = (mover == Chessboard::PlayerSide::Gote ? VariantBoard::kMaxNumCells : 0);
+    std::uint64_t key = player_key_;
+
+    for (VariantBoard::CellMask cells = VariantBoard::GetPieceMask(state, mover)
+        ^ VariantBoard::GetPieceMask(next, mover); cells != 0; cells &= cells - 1)
+    {
+        key ^= piece_keys_[offset + VariantBoard::LowestCell(cells)];
+    }
+    return key;
+}
+
+int SearchAI::Evaluate(const State& state) const
+{
+    // for the player to move: his open lines and moves against his enemy's.
+    const Chessboard::PlayerSide enemy = Chessboard::EnemyOfPlayer(state.player);
+    State enemy_state = state;
+    enemy_state.player = enemy;
+
+    const int num_lines = board_.CountOpenLines(state, state.player)
+        - board_.CountOpenLines(state, enemy);
+    const int num_moves = board_.CountMoves(state) - board_.CountMoves(enemy_state);
+    return num_lines * 8 + num_moves;
+}
+
+void SearchAI::MakeChildren(
+    const State& state,
+    std::uint64_t key,
+    int table_move,
+    std::vector<Child>& children) const
+{
+    children.clear();
+    board_.ForEachMove(state, [&](const State& next) {
+        Child child;
+        child.state = next;
+        child.key = key ^ HashStep(state, next);
+        child.move = static_cast<int>(children.size());
+        child.order = (child.move == table_move ? kInfinity
+            : board_.IsPlayerWin(next, state.player) ? kWinScore
+            : -Evaluate(next));
+        children.push_back(child);
+    });
+
+    assert(children.size() <= UINT8_MAX + 1);  // moves are 8 bits in the table.
+
+    std::stable_sort(children.begin(), children.end(),
+        [](const Child& a, const Child& b) { return a.order > b.order; });
+}
+
+int SearchAI::NegaMax(
+    const State& state,
+    std::uint64_t key,
+    int depth,
+    int ply,
+    int alpha,
+    int beta)
+{
+    ++stats_.num_nodes;
+    if (IsTimeOut())
+        return 0;
+
+    // the player moved last has won.
+    if (board_.IsPlayerWin(state, Chessboard::EnemyOfPlayer(state.player)))
+        return -(kWinScore - ply);
+
+    if (depth == 0)
+        return Evaluate(state);
+
+    TableEntry& entry = table_[key & (table_.size() - 1)];
+    int table_move = -1;
+    if (entry.key == key)
+    {
+        table_move = entry.move;
+        const int score = FromTableScore(entry.score, ply);
+        if (entry.depth >= depth
+            && (entry.bound == Bound::Exact
+                || (entry.bound == Bound::Lower && score >= beta)
+                || (entry.bound == Bound::Upper && score <= alpha)))
+            return score;
+    }
+
+    std::vector<Child>& children = child_stacks_[ply];
+    MakeChildren(state, key, table_move, children);
+
+    // no piece can move, the same as failed.
+    if (children.empty())
+        return -(kWinScore - ply);
+
+    const int original_alpha = alpha;
+    int best_score = -kInfinity;
+    int best_move = 0;
+
+    for (const Child& child : children)
+    {
+        const int score = -NegaMax(child.state, child.key, depth - 1, ply + 1, -beta, -alpha);
+        if (is_time_out_)
+            return 0;
+
+        if (score > best_score)
+        {
+            best_score = score;
+            best_move = child.move;
+        }
+
+        alpha = (std::max)(alpha, score);
+        if (alpha >= beta)
+            break;
+    }
+
+    entry.key = key;
+    entry.score = static_cast<std::int16_t>(ToTableScore(best_score, ply));
+    entry.depth = static_cast<std::int8_t>(depth);
+    entry.move = static_cast<std::uint8_t>(best_move);
+    entry.bound = (best_score <= original_alpha ? Bound::Upper
+        : best_score >= beta ? Bound::Lower : Bound::Exact);
+    return best_score;
+}
+
+bool SearchAI::IsTimeOut()
+{
+    if (!is_time_out_ && stats_.num_nodes % kNodesPerTimeCheck == 0)
+    {
+        is_time_out_ = ashes::time::Now() >= deadline_;
+    }
+    return is_time_out_;
+}
\ No newline at end of file
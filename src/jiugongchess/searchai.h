@@ -0,0 +1,100 @@
+﻿#ifndef JIUGONGCHESS_SEARCHAI_H
+#define JIUGONGCHESS_SEARCHAI_H
+
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+#include "ashes/time.h"
+#include "chessboard.h"
+#include "variantboard.h"
+
+//==============================================================================
+// SearchAI: search based AI of a VariantBoard, for variants too big to solve
+// out, and the Jiugong chessboard as the default variant.
+// iterative deepening negamax with alpha-beta pruning within a time budget.
+// a transposition table keyed by Zobrist hashing keeps scores, bounds and best
+// moves of searched states, moves are ordered by the table move, then winning
+// moves, then static evaluation. a win in n plies scores kWinScore - n.
+//==============================================================================
+
+class SearchAI
+{
+public:
+
+    typedef VariantBoard::State State;
+
+    static const int kWinScore = 10000;
+    static const int kMaxDepth = 100;
+
+    struct Stats
+    {
+        std::uint64_t num_nodes = 0;
+        int           depth = 0;      // of the last finished iteration.
+        int           score = 0;      // for the player to move.
+        double        seconds = 0.0;
+    };
+
+    explicit SearchAI(const VariantBoard::Rules& rules = VariantBoard::Rules(),
+        int table_bits = 20);
+    SearchAI(const SearchAI&) = delete;
+    ~SearchAI();
+    SearchAI& operator = (const SearchAI&) = delete;
+
+    void SetTimeBudget(ashes::time::Msecs budget);
+    void SetMaxDepth(int depth);
+
+    // search the best next state, the player to move must have a move.
+    State Search(const State& state);
+
+    // search on the Jiugong chessboard, the rules must be the default ones.
+    Chessboard::PieceStep HandleGameTurn(
+        const Chessboard& chessboard, Chessboard::PlayerSide player);
+
+    const VariantBoard& GetBoard() const;
+    const Stats& GetStats() const;
+    void PrintStats(std::ostream& os) const;
+
+private:
+
+    enum class Bound : std::uint8_t { Exact, Lower, Upper };
+
+    struct TableEntry
+    {
+        std::uint64_t key = 0;
+        std::int16_t  score = 0;
+        std::int8_t   depth = -1;
+        Bound         bound = Bound::Exact;
+        std::uint8_t  move = 0;  // index of the best move in move order.
+    };
+
+    struct Child
+    {
+        State         state;
+        std::uint64_t key = 0;
+        int           order = 0;  // searched first if bigger.
+        int           move = 0;   // index in move order.
+    };
+
+    std::uint64_t HashState(const State& state) const;
+    std::uint64_t HashStep(const State& state, const State& next) const;
+    int Evaluate(const State& state) const;
+
+    void MakeChildren(const State& state, std::uint64_t key, int table_move,
+        std::vector<Child>& children) const;
+    int NegaMax(const State& state, std::uint64_t key, int depth, int ply, int alpha, int beta);
+    bool IsTimeOut();
+
+    const VariantBoard              board_;
+    std::vector<std::uint64_t>      piece_keys_;    // at player * kMaxNumCells + cell.
+    std::uint64_t                   player_key_ = 0;
+    std::vector<TableEntry>         table_;         // 2^table_bits entries.
+    std::vector<std::vector<Child>> child_stacks_;  // indexed by ply, reused.
+
+    ashes::time::Msecs     time_budget_{500};
+    int                    max_depth_ = kMaxDepth;
+    ashes::time::TimePoint deadline_;
+    bool                   is_time_out_ = false;
+    Stats                  stats_;
+};
+
+#endif
\ No newline at end of file
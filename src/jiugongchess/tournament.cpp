@@ -0,0 +1,187 @@
+﻿#include "tournament.h"
+#include <atomic>
+#include <random>
+#include <thread>
+#include <cassert>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+#include "ashes/time.h"
+#include "jiugongchess.h"
+
+namespace {
+
+const std::uint64_t kChunkSize = 1024;  // games taken by a thread at a time.
+
+const char* GetLevelName(GameAI::Level level)
+{
+    switch (level)
+    {
+        case GameAI::Level::Stupid:     return "stupid";
+        case GameAI::Level::Mediocre:   return "mediocre";
+        case GameAI::Level::Invincible: return "invincible";
+        default: assert(false); return "";
+    }
+}
+
+double Percent(std::uint64_t count, std::uint64_t total)
+{
+    return total > 0 ? 100.0 * count / total : 0.0;
+}
+
+}
+
+Tournament::Tournament(std::uint64_t num_games, int num_threads, std::uint32_t seed)
+    : num_games_(num_games)
+    , num_threads_(num_threads > 0 ? num_threads
+        : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency())))
+    , seed_(seed)
+{
+}
+
+Tournament::~Tournament()
+{
+}
+
+void Tournament::Run()
+{
+    GameAI::Initialize();
+    results_.clear();
+
+    for (int sente = 0; sente < GameAI::kNumLevels; ++sente)
+    {
+        for (int gote = 0; gote < GameAI::kNumLevels; ++gote)
+        {
+            results_.push_back(RunPairing(
+                static_cast<GameAI::Level>(sente), static_cast<GameAI::Level>(gote)));
+        }
+    }
+}
+
+void Tournament::PrintResults(std::ostream& os) const
+{
+    os << "games: " << num_games_ << " each pairing"
+       << ", " << num_threads_ << " threads, seed " << seed_ << "\n";
+    os << std::left
+       << std::setw(12) << "sente" << std::setw(12) << "gote"
+       << std::right
+       << std::setw(11) << "sente win" << std::setw(11) << "gote win"
+       << std::setw(11) << "draw" << std::setw(12) << "avg steps"
+       << std::setw(16) << "decisions/sec" << "\n";
+
+    os << std::fixed;
+    for (const Result& result : results_)
+    {
+        const double avg_steps = result.num_games > 0
+            ? static_cast<double>(result.num_steps) / result.num_games : 0.0;
+        const double decisions_per_sec = result.seconds > 0.0
+            ? result.num_steps / result.seconds : 0.0;
+
+        os << std::left
+           << std::setw(12) << GetLevelName(result.sente_level)
+           << std::setw(12) << GetLevelName(result.gote_level)
+           << std::right << std::setprecision(2)
+           << std::setw(10) << Percent(result.num_sente_wins, result.num_games) << "%"
+           << std::setw(10) << Percent(result.num_gote_wins, result.num_games) << "%"
+           << std::setw(10) << Percent(result.num_draws, result.num_games) << "%"
+           << std::setw(12) << avg_steps
+           << std::setprecision(0)
+           << std::setw(16) << decisions_per_sec;
+        if (result.num_illegal_steps > 0)
+        {
+            os << "  " << result.num_illegal_steps << " illegal steps";
+        }
+        os << "\n";
+    }
+    os << std::defaultfloat;
+}
+
+const std::vector<Tournament::Result>& Tournament::GetResults() const
+{
+    return results_;
+}
+
+auto Tournament::RunPairing(
+    GameAI::Level sente_level,
+    GameAI::Level gote_level) const -> Result
+{
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+    const std::uint32_t pairing = static_cast<std::uint32_t>(
+        static_cast<int>(sente_level) * GameAI::kNumLevels + static_cast<int>(gote_level));
+    std::vector<Result> thread_results(num_threads_);
+    std::atomic<std::uint64_t> next_chunk(0);
+
+    auto task = [&](int thread_index) {
+        Result& result = thread_results[thread_index];
+        JiugongChess game;
+        GameAI sente_ai(Chessboard::PlayerSide::Sente);
+        GameAI gote_ai(Chessboard::PlayerSide::Gote);
+        sente_ai.SetLevel(sente_level);
+        gote_ai.SetLevel(gote_level);
+
+        for (;;)
+        {
+            const std::uint64_t first = next_chunk.fetch_add(1) * kChunkSize;
+            if (first >= num_games_)
+                break;
+
+            std::seed_seq seeds = {seed_, pairing, static_cast<std::uint32_t>(first / kChunkSize)};
+            std::mt19937 engine(seeds);
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+            const std::uint64_t last = (std::min)(first + kChunkSize, num_games_);
+            for (std::uint64_t index = first; index < last; ++index)
+            {
+                game.NewGame();
+                while (game.GetGameState() == JiugongChess::GameState::UnderWay)
+                {
+                    const GameAI& ai = (game.GetCurrentPlayer() == Chessboard::PlayerSide::Sente
+                        ? sente_ai : gote_ai);
+                    const Chessboard::PieceStep step = ai.HandleGameTurn(game.GetChessboard(), uniform(engine));
+                    bool success = game.MovePiece(step);
+                    assert(success);
+                    if (!success)
+                    {
+                        // a rejected step changes nothing, the game would never end.
+                        result.num_illegal_steps += 1;
+                        break;
+                    }
+                }
+
+                const JiugongChess::GameState state = game.GetGameState();
+                result.num_sente_wins += (state == JiugongChess::GameState::SenteWin ? 1 : 0);
+                result.num_gote_wins += (state == JiugongChess::GameState::GoteWin ? 1 : 0);
+                result.num_draws += (state == JiugongChess::GameState::Draw ? 1 : 0);
+                result.num_steps += game.GetNumSteps();
+                result.num_games += 1;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int thread_index = 1; thread_index < num_threads_; ++thread_index)
+    {
+        threads.emplace_back(task, thread_index);
+    }
+
+    task(0);
+    for (std::thread& thread : threads) { thread.join(); }
+
+    // sum results of all threads.
+    Result result;
+    result.sente_level = sente_level;
+    result.gote_level = gote_level;
+    for (const Result& thread_result : thread_results)
+    {
+        result.num_games += thread_result.num_games;
+        result.num_sente_wins += thread_result.num_sente_wins;
+        result.num_gote_wins += thread_result.num_gote_wins;
+        result.num_draws += thread_result.num_draws;
+        result.num_steps += thread_result.num_steps;
+        result.num_illegal_steps += thread_result.num_illegal_steps;
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    result.seconds = duration.count();
+    return result;
+}
\ No newline at end of file
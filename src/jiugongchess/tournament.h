@@ -0,0 +1,53 @@
+﻿#ifndef JIUGONGCHESS_TOURNAMENT_H
+#define JIUGONGCHESS_TOURNAMENT_H
+
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+#include "gameai.h"
+
+//==============================================================================
+// Tournament: headless self-play of GameAI against GameAI on JiugongChess,
+// for every pairing of sente and gote levels.
+// games of a pairing are played by all threads in chunks, each chunk has its
+// own random engine seeded by the chunk index, so results only depend on the
+// seed, not on the number of threads.
+//==============================================================================
+
+class Tournament
+{
+public:
+
+    struct Result
+    {
+        GameAI::Level sente_level = GameAI::Level::Stupid;
+        GameAI::Level gote_level = GameAI::Level::Stupid;
+        std::uint64_t num_games = 0;
+        std::uint64_t num_sente_wins = 0;
+        std::uint64_t num_gote_wins = 0;
+        std::uint64_t num_draws = 0;
+        std::uint64_t num_steps = 0;     // of all games, a step is a decision.
+        std::uint64_t num_illegal_steps = 0;  // rejected, their games are abandoned.
+        double        seconds = 0.0;
+    };
+
+    Tournament(std::uint64_t num_games, int num_threads = 0, std::uint32_t seed = 0);
+    Tournament(const Tournament&) = delete;
+    ~Tournament();
+    Tournament& operator = (const Tournament&) = delete;
+
+    void Run();
+    void PrintResults(std::ostream& os) const;
+    const std::vector<Result>& GetResults() const;
+
+private:
+
+    Result RunPairing(GameAI::Level sente_level, GameAI::Level gote_level) const;
+
+    const std::uint64_t num_games_;  // of each pairing.
+    const int           num_threads_;
+    const std::uint32_t seed_;
+    std::vector<Result> results_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,297 @@
+﻿#include "variantboard.h"
+#include <cassert>
+#include <algorithm>
+
+namespace {
+
+int CountCells(VariantBoard::CellMask mask)
+{
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) { ++count; }
+    return count;
+}
+
+VariantBoard::CellMask LowCellsMask(int num_cells)
+{
+    return num_cells >= VariantBoard::kMaxNumCells
+        ? ~VariantBoard::CellMask(0) : (VariantBoard::CellMask(1) << num_cells) - 1;
+}
+
+bool ValidateBoardShape(const VariantBoard::Rules& rules)
+{
+    return rules.num_rows > 0
+        && rules.num_cols > 0
+        && rules.num_rows * rules.num_cols <= VariantBoard::kMaxNumCells
+        && rules.num_pieces >= 2
+        && rules.num_pieces * 2 <= rules.num_rows * rules.num_cols;
+}
+
+// C(n, k) by Pascal's triangle, false if it overflows. entries on the way are
+// not bigger than C(n, k) for k <= n / 2, so they overflow only if it does.
+bool CheckedBinomial(int n, int k, std::uint64_t& binomial)
+{
+    std::vector<std::uint64_t> row(k + 1, 0);
+    row[0] = 1;
+    for (int i = 1; i <= n; ++i)
+    {
+        for (int j = (std::min)(i, k); j > 0; --j)
+        {
+            if (row[j] > UINT64_MAX - row[j - 1])
+                return false;
+            row[j] += row[j - 1];
+        }
+    }
+    binomial = row[k];
+    return true;
+}
+
+}
+
+bool VariantBoard::ValidateRules(const Rules& rules)
+{
+    return ValidateBoardShape(rules) && !HasTooManyStates(rules);
+}
+
+bool VariantBoard::HasTooManyStates(const Rules& rules)
+{
+    if (!ValidateBoardShape(rules))
+        return false;
+
+    // states are C(n, k) * C(n - k, k) * 2, which must be ranked in 64 bits.
+    const int num_cells = rules.num_rows * rules.num_cols;
+    std::uint64_t sente_binomial = 0;
+    std::uint64_t gote_binomial = 0;
+    return !CheckedBinomial(num_cells, rules.num_pieces, sente_binomial)
+        || !CheckedBinomial(num_cells - rules.num_pieces, rules.num_pieces, gote_binomial)
+        || sente_binomial > UINT64_MAX / 2 / gote_binomial;
+}
+
+VariantBoard::VariantBoard(const Rules& rules)
+    : rules_(rules)
+    , num_cells_(rules.num_rows * rules.num_cols)
+{
+    assert(ValidateRules(rules));
+
+    const int num_rows = rules_.num_rows;
+    const int num_cols = rules_.num_cols;
+    const auto cell_of = [num_cols](int x, int y) { return x + y * num_cols; };
+    const auto is_inside = [num_rows, num_cols](int x, int y) {
+        return 0 <= x && x < num_cols && 0 <= y && y < num_rows; };
+
+    // adjacency: orthogonal neighbours, and diagonal ones by connectivity.
+    adjacency_masks_.assign(num_cells_, 0);
+    for (int y = 0; y < num_rows; ++y)
+    {
+        for (int x = 0; x < num_cols; ++x)
+        {
+            const bool has_diagonal = rules_.connectivity == Connectivity::King
+                || (rules_.connectivity == Connectivity::Alquerque && (x + y) % 2 == 0);
+
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const bool is_diagonal = (dx != 0 && dy != 0);
+                    if ((dx == 0 && dy == 0) || (is_diagonal && !has_diagonal))
+                        continue;
+
+                    if (is_inside(x + dx, y + dy))
+                    {
+                        adjacency_masks_[cell_of(x, y)] |= CellMask(1) << cell_of(x + dx, y + dy);
+                    }
+                }
+            }
+        }
+    }
+
+    // lines: consecutive cells in 4 directions, indexed by the first cell
+    // which is also the lowest one.
+    static const int kDirections[4][2] = {{1, 0}, {0, 1}, {1, 1}, {-1, 1}};
+    line_masks_.assign(num_cells_, {});
+    for (int y = 0; y < num_rows; ++y)
+    {
+        for (int x = 0; x < num_cols; ++x)
+        {
+            for (const auto& direction : kDirections)
+            {
+                const int end_x = x + direction[0] * (rules_.num_pieces - 1);
+                const int end_y = y + direction[1] * (rules_.num_pieces - 1);
+                if (!is_inside(end_x, end_y))
+                    continue;
+
+                CellMask mask = 0;
+                for (int i = 0; i < rules_.num_pieces; ++i)
+                {
+                    mask |= CellMask(1) << cell_of(x + direction[0] * i, y + direction[1] * i);
+                }
+                line_masks_[cell_of(x, y)].push_back(mask);
+            }
+        }
+    }
+
+    // binomials by Pascal's triangle, C(n, k) for k <= num_pieces.
+    const int num_ks = rules_.num_pieces + 1;
+    binomials_.assign((num_cells_ + 1) * num_ks, 0);
+    for (int n = 0; n <= num_cells_; ++n)
+    {
+        binomials_[n * num_ks] = 1;
+        for (int k = 1; k < num_ks && n > 0; ++k)
+        {
+            binomials_[n * num_ks + k] =
+                binomials_[(n - 1) * num_ks + k - 1] + binomials_[(n - 1) * num_ks + k];
+        }
+    }
+}
+
+VariantBoard::~VariantBoard()
+{
+}
+
+const VariantBoard::Rules& VariantBoard::GetRules() const
+{
+    return rules_;
+}
+
+int VariantBoard::GetNumCells() const
+{
+    return num_cells_;
+}
+
+VariantBoard::StateRank VariantBoard::GetNumStates() const
+{
+    // valid rules keep it in 64 bits.
+    const int k = rules_.num_pieces;
+    return Binomial(num_cells_, k) * Binomial(num_cells_ - k, k) * 2;
+}
+
+VariantBoard::CellMask VariantBoard::GetAdjacencyMask(int cell) const
+{
+    assert(0 <= cell && cell < num_cells_);
+    return adjacency_masks_[cell];
+}
+
+VariantBoard::State VariantBoard::GetInitialState() const
+{
+    // gote pieces at the first cells, sente pieces at the last cells.
+    State state;
+    state.gote_mask = LowCellsMask(rules_.num_pieces);
+    state.sente_mask = LowCellsMask(num_cells_) & ~LowCellsMask(num_cells_ - rules_.num_pieces);
+    state.player = PlayerSide::Sente;
+    return state;
+}
+
+bool VariantBoard::IsPlayerWin(const State& state, PlayerSide player) const
+{
+    const CellMask mask = GetPieceMask(state, player);
+    if (mask == GetPieceMask(GetInitialState(), player))
+        return false;
+
+    const std::vector<CellMask>& lines = line_masks_[LowestCell(mask)];
+    return std::find(lines.begin(), lines.end(), mask) != lines.end();
+}
+
+VariantBoard::StateRank VariantBoard::RankState(const State& state) const
+{
+    // rank gote cells by their positions among the cells without sente pieces.
+    const CellMask other_mask = LowCellsMask(num_cells_) & ~state.sente_mask;
+    CellMask gote_positions = 0;
+    for (CellMask pieces = state.gote_mask; pieces != 0; pieces &= pieces - 1)
+    {
+        const int cell = LowestCell(pieces);
+        gote_positions |= CellMask(1) << CountCells(other_mask & LowCellsMask(cell));
+    }
+
+    const int k = rules_.num_pieces;
+    const StateRank board_rank = RankCombination(state.sente_mask)
+        * Binomial(num_cells_ - k, k) + RankCombination(gote_positions);
+    return board_rank * 2 + static_cast<StateRank>(state.player);
+}
+
+VariantBoard::State VariantBoard::UnRankState(StateRank rank) const
+{
+    assert(rank < GetNumStates());
+    const int k = rules_.num_pieces;
+    const std::uint64_t num_gote_ranks = Binomial(num_cells_ - k, k);
+    const StateRank board_rank = rank / 2;
+
+    State state;
+    state.player = static_cast<PlayerSide>(rank % 2);
+    state.sente_mask = UnRankCombination(board_rank / num_gote_ranks, k);
+
+    // deposit gote positions to the cells without sente pieces.
+    const CellMask other_mask = LowCellsMask(num_cells_) & ~state.sente_mask;
+    const CellMask gote_positions = UnRankCombination(board_rank % num_gote_ranks, k);
+    int position = 0;
+    for (CellMask others = other_mask; others != 0; others &= others - 1, ++position)
+    {
+        if (gote_positions & (CellMask(1) << position))
+        {
+            state.gote_mask |= others & (0 - others);
+        }
+    }
+
+    return state;
+}
+
+int VariantBoard::CountMoves(const State& state) const
+{
+    const CellMask space_mask = LowCellsMask(num_cells_) & ~(state.sente_mask | state.gote_mask);
+    int count = 0;
+    for (CellMask pieces = GetPieceMask(state, state.player); pieces != 0; pieces &= pieces - 1)
+    {
+        count += CountCells(adjacency_masks_[LowestCell(pieces)] & space_mask);
+    }
+    return count;
+}
+
+int VariantBoard::CountOpenLines(const State& state, PlayerSide player) const
+{
+    const CellMask piece_mask = GetPieceMask(state, player);
+    const CellMask enemy_mask = GetPieceMask(state, Chessboard::EnemyOfPlayer(player));
+    const CellMask initial_mask = GetPieceMask(GetInitialState(), player);
+    int count = 0;
+
+    for (const std::vector<CellMask>& lines : line_masks_)
+    {
+        for (CellMask line : lines)
+        {
+            count += ((line & enemy_mask) == 0
+                && line != initial_mask
+                && CountCells(line & piece_mask) == rules_.num_pieces - 1 ? 1 : 0);
+        }
+    }
+    return count;
+}
+
+std::uint64_t VariantBoard::Binomial(int n, int k) const
+{
+    assert(0 <= n && n <= num_cells_ && 0 <= k && k <= rules_.num_pieces);
+    return binomials_[n * (rules_.num_pieces + 1) + k];
+}
+
+std::uint64_t VariantBoard::RankCombination(CellMask mask) const
+{
+    // colexicographic rank: sum of C(position_i, i + 1) for the i-th position.
+    std::uint64_t rank = 0;
+    int i = 0;
+    for (; mask != 0; mask &= mask - 1)
+    {
+        rank += Binomial(LowestCell(mask), ++i);
+    }
+    return rank;
+}
+
+VariantBoard::CellMask VariantBoard::UnRankCombination(std::uint64_t rank, int k) const
+{
+    CellMask mask = 0;
+    for (int n = num_cells_ - 1; k > 0; --n)
+    {
+        assert(n >= 0);
+        if (Binomial(n, k) <= rank)
+        {
+            rank -= Binomial(n, k--);
+            mask |= CellMask(1) << n;
+        }
+    }
+    return mask;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+﻿#ifndef JIUGONGCHESS_VARIANTBOARD_H
+#define JIUGONGCHESS_VARIANTBOARD_H
+
+#include <vector>
+#include <cstdint>
+#include "chessboard.h"
+
+//==============================================================================
+// VariantBoard: rules of a Jiugong variant on a N×M board, with configurable
+// connectivity and number of pieces. a player wins if his pieces are in a
+// line of consecutive cells, except the line they start from.
+//
+// a state is two bitboards of up to 64 cells and the player to move. states
+// are ranked to a dense 64-bit index by combinations: the sente cells among
+// all cells, the gote cells among the other cells, then the player.
+//==============================================================================
+
+class VariantBoard
+{
+public:
+
+    //==========================================================================
+    // Constants & Types
+    //==========================================================================
+
+    static const int kMaxNumCells = 64;
+
+    typedef Chessboard::PlayerSide PlayerSide;
+    typedef std::uint64_t          CellMask;   // bit i for cell index i.
+    typedef std::uint64_t          StateRank;
+
+    enum class Connectivity
+    {
+        Orthogonal,  // up, down, left and right.
+        Alquerque,   // orthogonal, and diagonal at cells with even x+y.
+        King,        // orthogonal and diagonal.
+    };
+
+    struct Rules
+    {
+        int          num_rows = Chessboard::kNumRows;
+        int          num_cols = Chessboard::kNumCols;
+        int          num_pieces = Chessboard::kNumPiecesEachPlayer;  // each player.
+        Connectivity connectivity = Connectivity::Alquerque;        // as Jiugong.
+    };
+
+    struct State
+    {
+        CellMask   sente_mask = 0;
+        CellMask   gote_mask = 0;
+        PlayerSide player = PlayerSide::Sente;  // player to move.
+    };
+
+    //==========================================================================
+    // Rules
+    //==========================================================================
+
+    static bool ValidateRules(const Rules& rules);
+    static bool HasTooManyStates(const Rules& rules);  // to be ranked in 64 bits.
+
+    explicit VariantBoard(const Rules& rules);
+    ~VariantBoard();
+
+    const Rules& GetRules() const;
+    int GetNumCells() const;
+    StateRank GetNumStates() const;
+    CellMask GetAdjacencyMask(int cell) const;
+    static int LowestCell(CellMask mask);  // mask must not be zero.
+
+    //==========================================================================
+    // States
+    //==========================================================================
+
+    static CellMask GetPieceMask(const State& state, PlayerSide player);
+    State GetInitialState() const;
+    bool IsPlayerWin(const State& state, PlayerSide player) const;
+
+    StateRank RankState(const State& state) const;
+    State UnRankState(StateRank rank) const;
+
+    // visit next states of the player to move, or previous states which
+    // could move to the state.
+    template <class Visitor> void ForEachMove(const State& state, Visitor visitor) const;
+    template <class Visitor> void ForEachUnMove(const State& state, Visitor visitor) const;
+    int CountMoves(const State& state) const;
+
+    // number of lines which the player has all pieces but one in, and no
+    // enemy piece in, as a hint of his chances.
+    int CountOpenLines(const State& state, PlayerSide player) const;
+
+private:
+
+    //==========================================================================
+    // Privates
+    //==========================================================================
+
+    template <class Visitor>
+    void ForEachStep(const State& state, PlayerSide mover, Visitor visitor) const;
+
+    std::uint64_t Binomial(int n, int k) const;
+    std::uint64_t RankCombination(CellMask mask) const;
+    CellMask UnRankCombination(std::uint64_t rank, int k) const;
+
+    const Rules                        rules_;
+    const int                          num_cells_;
+    std::vector<CellMask>              adjacency_masks_;  // indexed by cell.
+    std::vector<std::vector<CellMask>> line_masks_;       // indexed by lowest cell.
+    std::vector<std::uint64_t>         binomials_;        // C(n, k) at n*(k_max+1)+k.
+};
+
+inline VariantBoard::CellMask VariantBoard::GetPieceMask(
+    const State& state,
+    PlayerSide player)
+{
+    return player == PlayerSide::Sente ? state.sente_mask : state.gote_mask;
+}
+
+template <class Visitor>
+void VariantBoard::ForEachMove(const State& state, Visitor visitor) const
+{
+    ForEachStep(state, state.player, visitor);
+}
+
+template <class Visitor>
+void VariantBoard::ForEachUnMove(const State& state, Visitor visitor) const
+{
+    ForEachStep(state, Chessboard::EnemyOfPlayer(state.player), visitor);
+}
+
+template <class Visitor>
+void VariantBoard::ForEachStep(
+    const State& state,
+    PlayerSide mover,
+    Visitor visitor) const
+{
+    // moves are reversible, so the previous states are made by moving the
+    // pieces of the player moved last, the same as his next states.
+    const CellMask space_mask = ~(state.sente_mask | state.gote_mask);
+    const CellMask piece_mask = GetPieceMask(state, mover);
+
+    for (CellMask pieces = piece_mask; pieces != 0; pieces &= pieces - 1)
+    {
+        const int cell = LowestCell(pieces);
+        const CellMask targets = adjacency_masks_[cell] & space_mask;
+
+        for (CellMask spaces = targets; spaces != 0; spaces &= spaces - 1)
+        {
+            State next = state;
+            const CellMask step_mask = (pieces & (0 - pieces)) | (spaces & (0 - spaces));
+            (mover == PlayerSide::Sente ? next.sente_mask : next.gote_mask) ^= step_mask;
+            next.player = Chessboard::EnemyOfPlayer(state.player);
+            visitor(next);
+        }
+    }
+}
+
+inline int VariantBoard::LowestCell(CellMask mask)
+{
+    // de Bruijn sequence, index of the isolated lowest bit.
+    static const int kCells[64] = {
+         0,  1, 48,  2, 57, 49, 28,  3, 61, 58, 50, 42, 38, 29, 17,  4,
+        62, 55, 59, 36, 53, 51, 43, 22, 45, 39, 33, 30, 24, 18, 12,  5,
+        63, 47, 56, 27, 60, 41, 37, 16, 54, 35, 52, 21, 44, 32, 23, 11,
+        46, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19,  9, 13,  8,  7,  6};
+    return kCells[((mask & (0 - mask)) * 0x03F79D71B4CB0A89ull) >> 58];
+}
+
+#endif
\ No newline at end of file
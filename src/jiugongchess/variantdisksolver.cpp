@@ -0,0 +1,260 @@
+﻿#include "variantdisksolver.h"
+#include <cassert>
+#include <ostream>
+#include <algorithm>
+#include "ashes/time.h"
+
+namespace {
+
+const std::uint32_t kMagic = 0x434F474A;  // "JGOC"
+const std::uint32_t kVersion = 1;
+
+const VariantBoard::StateRank kChunkSize = 1 << 16;  // states solved at a time.
+const ashes::time::Msecs kCheckpointInterval(10000);
+
+}
+
+struct VariantDiskSolver::Header
+{
+    std::uint32_t magic = kMagic;
+    std::uint32_t version = kVersion;
+    std::int32_t  num_rows = 0;
+    std::int32_t  num_cols = 0;
+    std::int32_t  num_pieces = 0;
+    std::int32_t  connectivity = 0;
+    std::uint64_t num_states = 0;
+    std::uint32_t pass = 0;          // pass 0 solves failed states.
+    std::uint32_t has_solved = 0;    // any state is solved in this pass.
+    std::uint64_t next_rank = 0;     // first rank of next chunk in this pass.
+    std::uint32_t is_finished = 0;
+    std::uint32_t reserved[3] = {};  // pad to 64 bytes.
+};
+
+VariantDiskSolver::VariantDiskSolver(
+    const VariantBoard::Rules& rules,
+    const std::string& path)
+    : board_(rules)
+    , path_(path)
+{
+}
+
+VariantDiskSolver::~VariantDiskSolver()
+{
+}
+
+bool VariantDiskSolver::Solve()
+{
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+    if (!OpenFile())
+        return false;
+
+    // progress is kept out of the mapped header until its results are saved.
+    Header progress = GetHeader();
+    ashes::time::TimePoint checkpoint_time = ashes::time::Now();
+    stats_.num_visited = 0;
+
+    while (!progress.is_finished)
+    {
+        // solve a pass by chunks, save progress at intervals.
+        while (progress.next_rank < progress.num_states)
+        {
+            const StateRank first = progress.next_rank;
+            const StateRank last = (std::min)(first + kChunkSize, progress.num_states);
+            if (SolveChunk(first, last, progress.pass == 0))
+            {
+                progress.has_solved = 1;
+            }
+
+            progress.next_rank = last;
+            stats_.num_visited += last - first;
+            if (ashes::time::Now() - checkpoint_time >= kCheckpointInterval)
+            {
+                Checkpoint(progress);
+                checkpoint_time = ashes::time::Now();
+            }
+        }
+
+        if (progress.pass > 0 && !progress.has_solved)
+        {
+            progress.is_finished = 1;
+        }
+        else
+        {
+            progress.pass += 1;
+            progress.has_solved = 0;
+            progress.next_rank = 0;
+        }
+        Checkpoint(progress);
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    stats_.seconds = duration.count();
+    CollectStats();
+    return true;
+}
+
+void VariantDiskSolver::PrintStats(std::ostream& os) const
+{
+    const VariantBoard::Rules& rules = board_.GetRules();
+    const double states_per_sec = stats_.seconds > 0.0
+        ? stats_.num_visited / stats_.seconds : 0.0;
+
+    os << "rules: " << rules.num_rows << "x" << rules.num_cols
+       << ", " << rules.num_pieces << " pieces\n";
+    os << "states: " << stats_.num_states
+       << " (win " << stats_.num_wins
+       << ", draw " << stats_.num_draws
+       << ", fail " << stats_.num_fails
+       << "), " << stats_.num_passes << " passes"
+       << (stats_.resumed ? ", resumed" : "") << "\n";
+    os << "time: " << stats_.seconds << " s"
+       << ", " << static_cast<std::uint64_t>(states_per_sec) << " states/sec"
+       << ", file " << stats_.file_size / 1024 << " KB\n";
+}
+
+const VariantBoard& VariantDiskSolver::GetBoard() const
+{
+    return board_;
+}
+
+const VariantDiskSolver::Stats& VariantDiskSolver::GetStats() const
+{
+    return stats_;
+}
+
+VariantDiskSolver::Type VariantDiskSolver::GetType(StateRank rank) const
+{
+    assert(results_ != nullptr);
+    const unsigned shift = static_cast<unsigned>(rank % 4) * 2;
+    return static_cast<Type>((results_[rank / 4] >> shift) & 3);
+}
+
+bool VariantDiskSolver::OpenFile()
+{
+    static_assert(sizeof(Header) == 64, "header should be 64 bytes.");
+    const VariantBoard::Rules& rules = board_.GetRules();
+    const StateRank num_states = board_.GetNumStates();
+    const std::uint64_t file_size = sizeof(Header) + (num_states + 3) / 4;
+    if (file_size > SIZE_MAX || !file_.Open(path_, static_cast<std::size_t>(file_size)))
+        return false;
+
+    results_ = reinterpret_cast<unsigned char*>(file_.GetData() + sizeof(Header));
+    stats_.file_size = file_size;
+
+    // resume if the file holds the same variant, or start over.
+    Header& header = GetHeader();
+    const bool is_same_variant = header.magic == kMagic
+        && header.version == kVersion
+        && header.num_rows == rules.num_rows
+        && header.num_cols == rules.num_cols
+        && header.num_pieces == rules.num_pieces
+        && header.connectivity == static_cast<std::int32_t>(rules.connectivity)
+        && header.num_states == num_states;
+
+    if (!is_same_variant)
+    {
+        header = Header();
+        header.num_rows = rules.num_rows;
+        header.num_cols = rules.num_cols;
+        header.num_pieces = rules.num_pieces;
+        header.connectivity = static_cast<std::int32_t>(rules.connectivity);
+        header.num_states = num_states;
+    }
+    else if (header.pass > 0 || header.next_rank > 0 || header.is_finished)
+    {
+        stats_.resumed = true;
+
+        // results solved after the checkpoint may be saved already, states
+        // before the checkpoint haven't seen them, so check them again.
+        header.has_solved = 1;
+    }
+
+    return true;
+}
+
+VariantDiskSolver::Header& VariantDiskSolver::GetHeader() const
+{
+    assert(file_.IsOpen());
+    return *reinterpret_cast<Header*>(file_.GetData());
+}
+
+void VariantDiskSolver::SetType(StateRank rank, Type type)
+{
+    const unsigned shift = static_cast<unsigned>(rank % 4) * 2;
+    unsigned char& byte = results_[rank / 4];
+    byte = static_cast<unsigned char>((byte & ~(3 << shift)) | static_cast<int>(type) << shift);
+}
+
+bool VariantDiskSolver::SolveChunk(
+    StateRank first,
+    StateRank last,
+    bool is_first_pass)
+{
+    bool has_solved = false;
+
+    for (StateRank rank = first; rank < last; ++rank)
+    {
+        const VariantBoard::State state = board_.UnRankState(rank);
+
+        if (is_first_pass)
+        {
+            // solve failed states and states no piece can move.
+            const bool is_failed = board_.IsPlayerWin(
+                state, Chessboard::EnemyOfPlayer(state.player));
+            SetType(rank, is_failed ? Type::Failed
+                : board_.CountMoves(state) == 0 ? Type::Fail : Type::Draw);
+            continue;
+        }
+
+        if (GetType(rank) != Type::Draw)
+            continue;
+
+        bool has_fail_next = false;
+        bool has_draw_next = false;
+        board_.ForEachMove(state, [&](const VariantBoard::State& next) {
+            const Type next_type = GetType(board_.RankState(next));
+            has_fail_next |= (next_type == Type::Fail || next_type == Type::Failed);
+            has_draw_next |= (next_type == Type::Draw);
+        });
+
+        if (has_fail_next || !has_draw_next)
+        {
+            SetType(rank, has_fail_next ? Type::Win : Type::Fail);
+            has_solved = true;
+        }
+    }
+
+    return has_solved;
+}
+
+void VariantDiskSolver::Checkpoint(const Header& progress)
+{
+    // pages reach the disk in any order, and unsaved results of pass 0 read
+    // as <win>. so results are saved before the progress which covers them.
+    file_.Flush();
+
+    Header& header = GetHeader();
+    header.pass = progress.pass;
+    header.has_solved = progress.has_solved;
+    header.next_rank = progress.next_rank;
+    header.is_finished = progress.is_finished;
+    file_.Flush();
+}
+
+void VariantDiskSolver::CollectStats()
+{
+    const Header& header = GetHeader();
+    stats_.num_states = header.num_states;
+    stats_.num_passes = static_cast<int>(header.pass) + 1;
+    stats_.num_wins = 0;
+    stats_.num_draws = 0;
+
+    for (StateRank rank = 0; rank < header.num_states; ++rank)
+    {
+        const Type type = GetType(rank);
+        stats_.num_wins += (type == Type::Win ? 1 : 0);
+        stats_.num_draws += (type == Type::Draw ? 1 : 0);
+    }
+
+    stats_.num_fails = stats_.num_states - stats_.num_wins - stats_.num_draws;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+﻿#ifndef JIUGONGCHESS_VARIANTDISKSOLVER_H
+#define JIUGONGCHESS_VARIANTDISKSOLVER_H
+
+#include <iosfwd>
+#include <string>
+#include <cstdint>
+#include "ashes/mappedfile.h"
+#include "gamesolver.h"
+#include "variantboard.h"
+
+//==============================================================================
+// VariantDiskSolver: out-of-core solver of all states of a VariantBoard, for
+// state spaces larger than memory.
+// results are 2-bit types packed in a memory-mapped file, after a header of
+// rules and progress. states are solved by passes over chunks of ranks: a
+// <draw> state is solved as <win> if a next state is <fail>/<failed>, or as
+// <fail> if all next states are <win>, until a pass solves nothing. results
+// are flushed before the progress in the header which covers them, so a solve
+// resumes from the last checkpoint saved in the header.
+// end steps are not kept, memory is the mapped pages only.
+//==============================================================================
+
+class VariantDiskSolver
+{
+public:
+
+    typedef VariantBoard::StateRank StateRank;
+    typedef GameSituation::Type     Type;
+
+    struct Stats
+    {
+        std::uint64_t num_states = 0;
+        std::uint64_t num_wins = 0;
+        std::uint64_t num_draws = 0;
+        std::uint64_t num_fails = 0;      // including failed states.
+        int           num_passes = 0;
+        std::uint64_t num_visited = 0;    // states visited by this run.
+        bool          resumed = false;    // resumed from a checkpoint.
+        double        seconds = 0.0;      // of this run only.
+        std::uint64_t file_size = 0;
+    };
+
+    VariantDiskSolver(const VariantBoard::Rules& rules, const std::string& path);
+    VariantDiskSolver(const VariantDiskSolver&) = delete;
+    ~VariantDiskSolver();
+    VariantDiskSolver& operator = (const VariantDiskSolver&) = delete;
+
+    bool Solve();  // false if the file can't be mapped.
+    void PrintStats(std::ostream& os) const;
+
+    const VariantBoard& GetBoard() const;
+    const Stats& GetStats() const;
+    Type GetType(StateRank rank) const;
+
+private:
+
+    struct Header;
+
+    bool OpenFile();
+    Header& GetHeader() const;
+    void SetType(StateRank rank, Type type);
+    bool SolveChunk(StateRank first, StateRank last, bool is_first_pass);
+    void Checkpoint(const Header& progress);
+    void CollectStats();
+
+    const VariantBoard board_;
+    const std::string  path_;
+    ashes::MappedFile  file_;
+    unsigned char*     results_ = nullptr;  // 4 states a byte.
+    Stats              stats_;
+};
+
+#endif
\ No newline at end of file
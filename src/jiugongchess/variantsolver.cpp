@@ -0,0 +1,284 @@
+﻿#include "variantsolver.h"
+#include <thread>
+#include <cassert>
+#include <ostream>
+#include <algorithm>
+#include "ashes/time.h"
+
+namespace {
+
+const std::size_t kChunkSize = 4096;  // states taken by a thread at a time.
+
+const char* GetConnectivityName(VariantBoard::Connectivity connectivity)
+{
+    switch (connectivity)
+    {
+        case VariantBoard::Connectivity::Orthogonal: return "orthogonal";
+        case VariantBoard::Connectivity::Alquerque:  return "alquerque";
+        case VariantBoard::Connectivity::King:       return "king";
+        default: assert(false); return "";
+    }
+}
+
+const char* GetTypeName(GameSituation::Type type)
+{
+    switch (type)
+    {
+        case GameSituation::Type::Win:    return "win";
+        case GameSituation::Type::Draw:   return "draw";
+        case GameSituation::Type::Fail:   return "fail";
+        case GameSituation::Type::Failed: return "failed";
+        default: assert(false); return "";
+    }
+}
+
+}
+
+VariantSolver::VariantSolver(const VariantBoard::Rules& rules, int num_threads)
+    : board_(rules)
+    , num_threads_(num_threads > 0 ? num_threads
+        : (std::max)(1, static_cast<int>(std::thread::hardware_concurrency())))
+{
+}
+
+VariantSolver::~VariantSolver()
+{
+}
+
+void VariantSolver::Solve()
+{
+    const ashes::time::TimePoint start_time = ashes::time::Now();
+    SolvedQueues solved_queues(num_threads_);
+    SolvedQueues next_queues(num_threads_);
+
+    // solve states level by level of end steps.
+    StartSolve(solved_queues);
+    for (;;)
+    {
+        const bool has_solved = std::any_of(solved_queues.begin(), solved_queues.end(),
+            [](const std::vector<StateRank>& queue) { return !queue.empty(); });
+        if (!has_solved)
+            break;
+
+        UpdatePrevStates(solved_queues, next_queues);
+        UpdatePeakMemory(solved_queues, next_queues);
+        solved_queues.swap(next_queues);
+    }
+
+    const std::chrono::duration<double> duration = ashes::time::Now() - start_time;
+    stats_.seconds = duration.count();
+    stats_.num_threads = num_threads_;
+    CollectStats();
+}
+
+void VariantSolver::PrintStats(std::ostream& os) const
+{
+    const VariantBoard::Rules& rules = board_.GetRules();
+    const StateRank initial_rank = board_.RankState(board_.GetInitialState());
+    const double states_per_sec = stats_.seconds > 0.0 ? stats_.num_states / stats_.seconds : 0.0;
+
+    os << "rules: " << rules.num_rows << "x" << rules.num_cols
+       << ", " << rules.num_pieces << " pieces"
+       << ", " << GetConnectivityName(rules.connectivity) << "\n";
+    os << "initial: " << GetTypeName(GetType(initial_rank))
+       << " in " << GetEndSteps(initial_rank) << " steps\n";
+    os << "states: " << stats_.num_states
+       << " (win " << stats_.num_wins
+       << ", draw " << stats_.num_draws
+       << ", fail " << stats_.num_fails
+       << "), max end steps " << stats_.max_end_steps << "\n";
+    os << "time: " << stats_.seconds << " s"
+       << ", " << static_cast<std::uint64_t>(states_per_sec) << " states/sec"
+       << ", peak memory " << stats_.peak_memory / 1024 << " KB"
+       << ", " << stats_.num_threads << " threads\n";
+}
+
+const VariantBoard& VariantSolver::GetBoard() const
+{
+    return board_;
+}
+
+const VariantSolver::Stats& VariantSolver::GetStats() const
+{
+    return stats_;
+}
+
+VariantSolver::Type VariantSolver::GetType(StateRank rank) const
+{
+    return static_cast<Type>(types_[rank].load(std::memory_order_relaxed));
+}
+
+int VariantSolver::GetEndSteps(StateRank rank) const
+{
+    return end_steps_[rank];
+}
+
+void VariantSolver::RunThreads(const std::function<void(int)>& task) const
+{
+    std::vector<std::thread> threads;
+    for (int thread_index = 1; thread_index < num_threads_; ++thread_index)
+    {
+        threads.emplace_back(task, thread_index);
+    }
+
+    task(0);
+    for (std::thread& thread : threads) { thread.join(); }
+}
+
+void VariantSolver::StartSolve(SolvedQueues& solved_queues)
+{
+    const StateRank num_states = board_.GetNumStates();
+    assert(num_states <= SIZE_MAX);
+    types_.reset(new std::atomic<std::uint8_t>[static_cast<std::size_t>(num_states)]);
+    num_draw_moves_.reset(new std::atomic<std::uint8_t>[static_cast<std::size_t>(num_states)]);
+    end_steps_.assign(static_cast<std::size_t>(num_states), 0);
+
+    // solve failed states and states no piece can move, by chunks of ranks.
+    std::atomic<StateRank> next_chunk(0);
+    RunThreads([&](int thread_index) {
+        std::vector<StateRank>& solved_ranks = solved_queues[thread_index];
+        for (;;)
+        {
+            const StateRank first = next_chunk.fetch_add(kChunkSize);
+            if (first >= num_states)
+                break;
+
+            const StateRank last = (std::min)(first + kChunkSize, num_states);
+            for (StateRank rank = first; rank < last; ++rank)
+            {
+                const VariantBoard::State state = board_.UnRankState(rank);
+                const int num_moves = board_.CountMoves(state);
+                assert(num_moves <= UINT8_MAX);
+                Type type = Type::Draw;
+
+                if (board_.IsPlayerWin(state, Chessboard::EnemyOfPlayer(state.player)))
+                {
+                    type = Type::Failed;
+                    solved_ranks.push_back(rank);
+                }
+                else if (num_moves == 0)
+                {
+                    type = Type::Fail;
+                    solved_ranks.push_back(rank);
+                }
+
+                types_[rank].store(static_cast<std::uint8_t>(type), std::memory_order_relaxed);
+                num_draw_moves_[rank].store(
+                    static_cast<std::uint8_t>(num_moves), std::memory_order_relaxed);
+            }
+        }
+    });
+}
+
+void VariantSolver::UpdatePrevStates(
+    const SolvedQueues& solved_queues,
+    SolvedQueues& next_queues)
+{
+    // number the chunks of all queues, then threads take chunks in turn.
+    std::vector<std::size_t> chunk_offsets(1, 0);
+    for (const std::vector<StateRank>& queue : solved_queues)
+    {
+        const std::size_t num_chunks = (queue.size() + kChunkSize - 1) / kChunkSize;
+        chunk_offsets.push_back(chunk_offsets.back() + num_chunks);
+    }
+
+    std::atomic<std::size_t> next_chunk(0);
+    RunThreads([&](int thread_index) {
+        std::vector<StateRank>& solved_ranks = next_queues[thread_index];
+        solved_ranks.clear();
+
+        for (;;)
+        {
+            const std::size_t chunk = next_chunk.fetch_add(1);
+            if (chunk >= chunk_offsets.back())
+                break;
+
+            const std::size_t queue_index = std::upper_bound(
+                chunk_offsets.begin(), chunk_offsets.end(), chunk) - chunk_offsets.begin() - 1;
+            const std::vector<StateRank>& queue = solved_queues[queue_index];
+            const std::size_t first = (chunk - chunk_offsets[queue_index]) * kChunkSize;
+            const std::size_t last = (std::min)(first + kChunkSize, queue.size());
+
+            for (std::size_t i = first; i < last; ++i)
+            {
+                UpdatePrevStates(queue[i], solved_ranks);
+            }
+        }
+    });
+}
+
+void VariantSolver::UpdatePrevStates(
+    StateRank rank,
+    std::vector<StateRank>& solved_ranks)
+{
+    const Type type = GetType(rank);
+    assert(end_steps_[rank] < UINT16_MAX);
+    const std::uint16_t prev_end_steps = static_cast<std::uint16_t>(end_steps_[rank] + 1);
+
+    board_.ForEachUnMove(board_.UnRankState(rank), [&](const VariantBoard::State& prev) {
+        const StateRank prev_rank = board_.RankState(prev);
+        std::atomic<std::uint8_t>& prev_type = types_[prev_rank];
+        if (prev_type.load(std::memory_order_relaxed) != static_cast<std::uint8_t>(Type::Draw))
+            return;
+
+        // the first <fail> next is the fastest win, the last <win> next is
+        // the slowest fail, since states are solved in order of end steps.
+        // a state with a <fail> next never runs out of draw moves, so only
+        // one thread solves it, either by the exchange or the counter.
+        if (type == Type::Win)
+        {
+            if (num_draw_moves_[prev_rank].fetch_sub(1, std::memory_order_relaxed) != 1)
+                return;
+
+            prev_type.store(static_cast<std::uint8_t>(Type::Fail), std::memory_order_relaxed);
+        }
+        else
+        {
+            std::uint8_t draw = static_cast<std::uint8_t>(Type::Draw);
+            if (!prev_type.compare_exchange_strong(draw,
+                static_cast<std::uint8_t>(Type::Win), std::memory_order_relaxed))
+                return;
+        }
+
+        end_steps_[prev_rank] = prev_end_steps;
+        solved_ranks.push_back(prev_rank);
+    });
+}
+
+void VariantSolver::CollectStats()
+{
+    stats_.num_states = board_.GetNumStates();
+    stats_.num_wins = 0;
+    stats_.num_draws = 0;
+
+    for (StateRank rank = 0; rank < stats_.num_states; ++rank)
+    {
+        const Type type = GetType(rank);
+        stats_.num_wins += (type == Type::Win ? 1 : 0);
+        stats_.num_draws += (type == Type::Draw ? 1 : 0);
+    }
+
+    stats_.num_fails = stats_.num_states - stats_.num_wins - stats_.num_draws;
+    stats_.max_end_steps = end_steps_.empty() ? 0
+        : *std::max_element(end_steps_.begin(), end_steps_.end());
+}
+
+void VariantSolver::UpdatePeakMemory(
+    const SolvedQueues& queues1,
+    const SolvedQueues& queues2)
+{
+    const std::size_t num_states = static_cast<std::size_t>(board_.GetNumStates());
+    std::size_t memory = num_states * sizeof(types_[0])
+        + num_states * sizeof(num_draw_moves_[0])
+        + end_steps_.capacity() * sizeof(end_steps_[0]);
+
+    for (const SolvedQueues* queues : {&queues1, &queues2})
+    {
+        for (const std::vector<StateRank>& queue : *queues)
+        {
+            memory += queue.capacity() * sizeof(StateRank);
+        }
+    }
+
+    stats_.peak_memory = (std::max)(stats_.peak_memory, memory);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+﻿#ifndef JIUGONGCHESS_VARIANTSOLVER_H
+#define JIUGONGCHESS_VARIANTSOLVER_H
+
+#include <atomic>
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include "gamesolver.h"
+#include "variantboard.h"
+
+//==============================================================================
+// VariantSolver: retrograde solver of all states of a VariantBoard.
+// states are kept in flat arrays indexed by state rank, and are solved level
+// by level of end steps, previous states are made by unmoves instead of
+// stored links, so memory is a few bytes per state.
+//
+// each level is solved by all threads: they take chunks of the rank range or
+// of the solved queues in turn, push states they solve to their own queues,
+// and update types and counters by atomic operations without locks. a state
+// is solved by only one thread, so results are the same as a serial solve.
+//==============================================================================
+
+class VariantSolver
+{
+public:
+
+    typedef VariantBoard::StateRank StateRank;
+    typedef GameSituation::Type     Type;
+
+    struct Stats
+    {
+        std::uint64_t num_states = 0;
+        std::uint64_t num_wins = 0;
+        std::uint64_t num_draws = 0;
+        std::uint64_t num_fails = 0;      // including failed states.
+        int           max_end_steps = 0;
+        int           num_threads = 0;
+        double        seconds = 0.0;
+        std::size_t   peak_memory = 0;    // bytes of state arrays and queues.
+    };
+
+    // use all cores if num_threads is 0.
+    explicit VariantSolver(const VariantBoard::Rules& rules, int num_threads = 0);
+    VariantSolver(const VariantSolver&) = delete;
+    ~VariantSolver();
+    VariantSolver& operator = (const VariantSolver&) = delete;
+
+    void Solve();
+    void PrintStats(std::ostream& os) const;
+
+    const VariantBoard& GetBoard() const;
+    const Stats& GetStats() const;
+    Type GetType(StateRank rank) const;
+    int GetEndSteps(StateRank rank) const;
+
+private:
+
+    typedef std::vector<std::vector<StateRank>> SolvedQueues;  // one per thread.
+
+    template <class T>
+    using AtomicArray = std::unique_ptr<std::atomic<T>[]>;
+
+    void RunThreads(const std::function<void(int)>& task) const;
+    void StartSolve(SolvedQueues& solved_queues);
+    void UpdatePrevStates(const SolvedQueues& solved_queues, SolvedQueues& next_queues);
+    void UpdatePrevStates(StateRank rank, std::vector<StateRank>& solved_ranks);
+    void CollectStats();
+    void UpdatePeakMemory(const SolvedQueues& queues1, const SolvedQueues& queues2);
+
+    const VariantBoard         board_;
+    const int                  num_threads_;
+    AtomicArray<std::uint8_t>  types_;           // Type of each state.
+    AtomicArray<std::uint8_t>  num_draw_moves_;  // moves not known to lose.
+    std::vector<std::uint16_t> end_steps_;       // win/fail steps if both play best.
+    Stats                      stats_;
+};
+
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 ﻿#include "console.h"
 #include <cctype>
 #include <cassert>
+#include <climits>
 #include <algorithm>
 #include "winapi.h"
 
@@ -8,22 +9,20 @@ namespace ashes {
 
 namespace {
 
-CONSOLE_SCREEN_BUFFER_INFOEX GetConsoleBufferInfoEX(HANDLE console)
-{
-    CONSOLE_SCREEN_BUFFER_INFOEX info = {sizeof(info)};
-    BOOL success = ::GetConsoleScreenBufferInfoEx(console, &info);
-    assert(success);
-    return info;
-}
+// a clean span which is empty and can be extended by min/max.
+const Console::CoordRange kCleanSpan = {SHRT_MAX, -1};
+
+// backend installed for the console to create, and whether it's created.
+std::unique_ptr<ConsoleBackend> g_installed_backend;
+bool                            g_console_created = false;
 
-bool ResizeConsoleBuffer(HANDLE console, Coord size)
+UINT GetInputCodePage()
 {
-    CONSOLE_SCREEN_BUFFER_INFOEX info = GetConsoleBufferInfoEX(console);
-    info.dwSize = size;
-    info.dwMaximumWindowSize = size;
-    info.srWindow = Rect({0, 0}, size);
-    info.srWindow.Bottom += 1;
-    return ::SetConsoleScreenBufferInfoEx(console, &info);
+#ifdef _WIN32
+    return ::GetConsoleCP();
+#else
+    return CP_UTF8;
+#endif
 }
 
 void ModifyCharInfo(CHAR_INFO& ci, wchar_t ch, WORD lvb_attributes, WORD color)
@@ -33,12 +32,28 @@ void ModifyCharInfo(CHAR_INFO& ci, wchar_t ch, WORD lvb_attributes, WORD color)
     ci.Attributes = graph::BlendColor(ci.Attributes, color);
 }
 
+bool IsSameCharInfo(const CHAR_INFO& a, const CHAR_INFO& b)
+{
+    return a.Char.UnicodeChar == b.Char.UnicodeChar && a.Attributes == b.Attributes;
+}
+
 }
 
 //==============================================================================
 // Console
 //==============================================================================
 
+bool Console::SetBackend(std::unique_ptr<ConsoleBackend> backend)
+{
+    assert(backend != nullptr);
+
+    if (g_console_created)
+        return false;
+
+    g_installed_backend = std::move(backend);
+    return true;
+}
+
 Coord Console::Size() const
 {
     return window_size_;
@@ -51,90 +66,43 @@ Rect Console::Region() const
 
 bool Console::Resize(const Coord& size)
 {
-    if (!ResizeConsoleBuffer(window_output_, size))
-        return false;
-
-    if (!EnableDoubleBuffer(IsDoubleBufferEnabled()))
+    if (!backend_->Resize(size))
         return false;
 
+    ResizeFrameBuffer(size);
     window_size_ = size;
+    InvalidateFrameRegion(Region());
     return true;
 }
 
 void Console::Center()
 {
-    BOOL success = TRUE;
-    HWND window = ::GetConsoleWindow();
-    assert(window != NULL);
-
-    // window size
-    RECT window_rect;
-    success = ::GetWindowRect(window, &window_rect);
-    assert(success);
-    LONG width = window_rect.right - window_rect.left;
-    LONG height = window_rect.bottom - window_rect.top;
-
-    // work area size
-    RECT work_area;
-    success = ::SystemParametersInfo(SPI_GETWORKAREA, 0, &work_area, 0);
-    assert(success);
-    LONG work_area_width = work_area.right - work_area.left;
-    LONG work_area_height = work_area.bottom - work_area.top;
-
-    // center
-    LONG left = work_area.left + (work_area_width  - width)  / 2;
-    LONG top  = work_area.top  + (work_area_height - height) / 2;
-    success = ::SetWindowPos(window, HWND_TOPMOST, left, top, 0, 0, SWP_NOSIZE);
-    assert(success);
+    backend_->Center();
 }
 
 void Console::SetUnresizable()
 {
-    HWND window = ::GetConsoleWindow();
-    assert(window != NULL);
-    LONG style = ::GetWindowLong(window, GWL_STYLE);
-    style &= ~(WS_MAXIMIZEBOX | WS_SIZEBOX);
-    ::SetWindowLong(window, GWL_STYLE, style);
+    backend_->SetUnresizable();
 }
 
 void Console::SetCodePage(UINT code_page)
 {
-    BOOL success = ::SetConsoleOutputCP(code_page);
-    assert(success);
+    backend_->SetCodePage(code_page);
 }
 
 void Console::SetFont(const std::wstring& face_name, const Coord& size, UINT weight)
 {
-    CONSOLE_FONT_INFOEX info = {0};
-    info.cbSize = sizeof(info);
-    info.FontWeight = weight;
-    info.dwFontSize = size;
-    ::wcscpy_s(info.FaceName, face_name.c_str());
-    BOOL success = ::SetCurrentConsoleFontEx(window_output_, FALSE, &info);
-    assert(success);
+    backend_->SetFont(face_name, size, weight);
 }
 
 void Console::SetTitle(const String& title)
 {
-    BOOL success = ::SetConsoleTitle(title.c_str());
-    assert(success);
+    backend_->SetTitle(title);
 }
 
 void Console::SetUneditable()
 {
-    BOOL success = TRUE;
-
-    // disable quick edit mode.
-    DWORD mode = 0;
-    success = ::GetConsoleMode(input_, &mode);
-    assert(success);
-    success = ::SetConsoleMode(input_, mode & ~ENABLE_QUICK_EDIT_MODE);
-    assert(success);
-
-    // hide console cursor.
-    CONSOLE_CURSOR_INFO cursor_info = {1, FALSE};
-    success = ::SetConsoleCursorInfo(window_output_, &cursor_info);
-    assert(success);
+    backend_->SetUneditable();
 }
 
 void Console::SetDefaultBorder(ashes::graph::Border border)
@@ -156,10 +124,7 @@ void Console::SetDefaultBorderColor(WORD color)
 
 int Console::CountEvent() const
 {
-    DWORD number = 0;
-    BOOL success = ::GetNumberOfConsoleInputEvents(input_, &number);
-    assert(success);
-    return static_cast<int>(number);
+    return backend_->CountEvent();
 }
 
 bool Console::ReadEvent(INPUT_RECORD& event)
@@ -174,19 +139,22 @@ bool Console::ReadEvent(INPUT_RECORD& event)
 
 void Console::WaitEvent(INPUT_RECORD& event)
 {
-    DWORD readed_number = 0;
-    ::ReadConsoleInput(input_, &event, 1, &readed_number);
-    assert(readed_number == 1);
+    backend_->WaitEvent(event);
+}
+
+bool Console::WaitEventFor(time::Msecs timeout)
+{
+    return backend_->WaitEventFor(timeout);
 }
 
 SHORT Console::MeasureWidth(wchar_t ch)
 {
-    return ::iswascii(ch) ? 1 : 2;
+    return static_cast<unsigned int>(ch) < 0x80 ? 1 : 2;
 }
 
 SHORT Console::MeasureWidth(const char* str)
 {
-    return MeasureWidth(win::A2W(str, -1, ::GetConsoleCP()).data());
+    return MeasureWidth(win::A2W(str, -1, GetInputCodePage()).data());
 }
 
 SHORT Console::MeasureWidth(const wchar_t* str)
@@ -203,25 +171,15 @@ void Console::DrawColor(WORD color, const Rect& rect)
 
     if (!rect.IsEmpty() && !clamped_rect.IsEmpty())
     {
-        BOOL success = TRUE;
-        elem_buffer_.resize(clamped_size.X * clamped_size.Y);
-
-        // read char infos inside rect region.
-        Rect read_region = clamped_rect;
-        success = ::ReadConsoleOutputW(output_, elem_buffer_.data(),
-            clamped_size, {0, 0}, &read_region);
-        assert(success);
-    
-        // modify color attributes in char infos.
-        std::for_each(elem_buffer_.begin(), elem_buffer_.end(), 
-            [color](CHAR_INFO& ci) {
+        // modify color attributes in char infos inside rect region.
+        for (SHORT y = clamped_rect.Top; y <= clamped_rect.Bottom; ++y)
+        {
+            CHAR_INFO* line = &FrameCell(clamped_rect.Left, y);
+            std::for_each(line, line + clamped_size.X, [color](CHAR_INFO& ci) {
                 ci.Attributes = graph::BlendColor(ci.Attributes, color); });
+        }
 
-        // write char infos back to rect region.
-        Rect write_region = clamped_rect;
-        success = ::WriteConsoleOutputW(output_, elem_buffer_.data(),
-            clamped_size, {0, 0}, &write_region);
-        assert(success);
+        InvalidateFrameRegion(clamped_rect);
     }
 }
 
@@ -250,24 +208,15 @@ void Console::DrawBlank(const Rect& rect, WORD color)
 
     if (!rect.IsEmpty() && !clamped_rect.IsEmpty())
     {
-        elem_buffer_.resize(clamped_size.X * clamped_size.Y);
-        BOOL success = TRUE;
-
-        // read char infos inside rect region.
-        Rect read_region = clamped_rect;
-        success = ::ReadConsoleOutputW(output_, elem_buffer_.data(),
-            clamped_size, {0, 0}, &read_region);
-        assert(success);
-
-        // modify character and color attributes in char infos.
-        std::for_each(elem_buffer_.begin(), elem_buffer_.end(), 
-            [color](CHAR_INFO& ci) { ModifyCharInfo(ci, L' ', 0, color); });
-
-        // write char infos back to rect region.
-        Rect write_region = clamped_rect;
-        success = ::WriteConsoleOutputW(output_, elem_buffer_.data(),
-            clamped_size, {0, 0}, &write_region);
-        assert(success);
+        // modify character and color attributes in char infos inside rect region.
+        for (SHORT y = clamped_rect.Top; y <= clamped_rect.Bottom; ++y)
+        {
+            CHAR_INFO* line = &FrameCell(clamped_rect.Left, y);
+            std::for_each(line, line + clamped_size.X, [color](CHAR_INFO& ci) {
+                ModifyCharInfo(ci, L' ', 0, color); });
+        }
+
+        InvalidateFrameRegion(clamped_rect);
     }
 }
 
@@ -340,57 +289,62 @@ Rect Console::DrawFramedStrings(
 
 bool Console::IsDoubleBufferEnabled() const
 {
-    return output_ == memory_output_;
+    return double_buffer_;
 }
 
 bool Console::EnableDoubleBuffer(bool enable)
 {
-    output_ = window_output_;
-
-    if (enable && CreateDoubleBuffer())
+    if (double_buffer_ && !enable)
     {
-        output_ = memory_output_;
+        FlushDoubleBuffer();
     }
 
-    return IsDoubleBufferEnabled() == enable;
+    double_buffer_ = enable;
+    return true;
 }
 
 void Console::FlushDoubleBuffer()
 {
-    // allocate char infos buffer.
-    const Coord buffer_size = Size();
-    elem_buffer_.resize(buffer_size.X * buffer_size.Y);
-    BOOL success = TRUE;
-
-    // read all char info from memory double buffer.
-    Rect read_region = {{0, 0}, buffer_size};
-    success = ::ReadConsoleOutputW(memory_output_, elem_buffer_.data(),
-        buffer_size, {0, 0}, &read_region);
-    assert(success);
+    PresentFrameBuffer();
+}
 
-    // write all char info to console window buffer.
-    Rect write_region = {{0, 0}, buffer_size};
-    success = ::WriteConsoleOutputW(window_output_, elem_buffer_.data(),
-        buffer_size, {0, 0}, &write_region);
-    assert(success);
+const Console::PresentStats& Console::GetPresentStats() const
+{
+    return present_stats_;
 }
 
-Console::Console()
+std::wstring Console::Snapshot() const
 {
-    input_ = ::GetStdHandle(STD_INPUT_HANDLE);
-    output_ = ::GetStdHandle(STD_OUTPUT_HANDLE);
+    std::wstring text;
+    text.reserve((window_size_.X + 1) * window_size_.Y);
+
+    // characters presented on console, a line per row, wide ones once.
+    for (SHORT y = 0; y < window_size_.Y; ++y)
+    {
+        const CHAR_INFO* line = &presented_buffer_[y * window_size_.X];
+        for (SHORT x = 0; x < window_size_.X; ++x)
+        {
+            if (!(line[x].Attributes & COMMON_LVB_TRAILING_BYTE))
+                text += line[x].Char.UnicodeChar;
+        }
+        text += L'\n';
+    }
 
-    assert(input_ != INVALID_HANDLE_VALUE);
-    assert(output_ != INVALID_HANDLE_VALUE);
+    return text;
+}
 
-    window_output_ = output_;
-    window_size_ = GetConsoleBufferInfoEX(window_output_).dwSize;
+Console::Console()
+{
+    backend_ = (g_installed_backend != nullptr
+        ? std::move(g_installed_backend) : ConsoleBackend::MakeDefaultBackend());
+    g_console_created = true;
+    window_size_ = backend_->Size();
     default_border_ = graph::BorderThickDoubleLine();
+    SyncFrameBuffer();
 }
 
 Console::~Console()
 {
-    DestroyDoubleBuffer();
 }
 
 void Console::HoriLeftAlignClamp(
@@ -477,12 +431,12 @@ const graph::Border& Console::GetBorder(const graph::Border* specified_border) c
 
 Rect Console::DrawStringA(const std::string& str, const Coord& coord, WORD color)
 {
-    return DrawStringW(win::A2W(str, ::GetConsoleCP()), coord, color);
+    return DrawStringW(win::A2W(str, GetInputCodePage()), coord, color);
 }
 
 Rect Console::DrawStringA(const std::string& str, const Rect& rect, WORD color)
 {
-    return DrawStringW(win::A2W(str, ::GetConsoleCP()), rect, color);
+    return DrawStringW(win::A2W(str, GetInputCodePage()), rect, color);
 }
 
 Rect Console::DrawStringsA(
@@ -500,7 +454,7 @@ Rect Console::DrawStringsA(
     for (SHORT y = yanchor.first ; y <= yanchor.second ; ++y)
     {
         const std::string& str = strs[y - yanchor.first + yindexes.first];
-        std::wstring wstr = win::A2W(str, ::GetConsoleCP());
+        std::wstring wstr = win::A2W(str, GetInputCodePage());
         CoordRange xanchor = {rect.Left, rect.Right};
         CoordRange xindexes;
         HoriMidAlignClamp(wstr, xanchor, {clip.Left, clip.Right}, xindexes);
@@ -604,20 +558,10 @@ void Console::WriteOutput(
     SHORT y,
     WORD color)
 {
-    BOOL success = TRUE;
-
-    // allocate char infos buffer.
     const Rect region = {xrange.first, y, xrange.second, y};
-    elem_buffer_.resize(region.Width());
-    CHAR_INFO* elem = elem_buffer_.data();
-
-    // read char infos at line coord.Y.
-    Rect read_region = region;
-    success = ::ReadConsoleOutputW(output_, elem_buffer_.data(),
-        region.Size(), {0, 0}, &read_region);
-    assert(success);
+    CHAR_INFO* elem = &FrameCell(region.Left, y);
 
-    // modify character and color attributes in char infos.    
+    // modify character and color attributes in char infos at line y.
     for (SHORT idx = indexes.first; idx <= indexes.second; ++idx)
     {
         const wchar_t ch = str[idx];
@@ -634,43 +578,146 @@ void Console::WriteOutput(
         }
     }
 
-    // write char infos back to line coord.Y
-    Rect write_region = region;
-    success = ::WriteConsoleOutputW(output_, elem_buffer_.data(), 
-        region.Size(), {0, 0}, &write_region);
-    assert(success);
+    InvalidateFrameRegion(region);
 }
 
-bool Console::CreateDoubleBuffer()
+CHAR_INFO& Console::FrameCell(SHORT x, SHORT y)
 {
-    // create console screen buffer.
-    if (memory_output_ == INVALID_HANDLE_VALUE)
+    assert(Region().Contain(Coord(x, y)));
+    return frame_buffer_[y * window_size_.X + x];
+}
+
+void Console::SyncFrameBuffer()
+{
+    // read char infos of whole window once.
+    presented_buffer_.resize(window_size_.X * window_size_.Y);
+    backend_->ReadOutput(presented_buffer_.data(), window_size_);
+
+    frame_buffer_ = presented_buffer_;
+    dirty_spans_.assign(window_size_.Y, kCleanSpan);
+    dirty_lines_ = kCleanSpan;
+}
+
+void Console::ResizeFrameBuffer(const Coord& size)
+{
+    // read char infos of resized window.
+    presented_buffer_.resize(size.X * size.Y);
+    backend_->ReadOutput(presented_buffer_.data(), size);
+
+    // keep char infos inside the overlapped region, just like console does.
+    std::vector<CHAR_INFO> frame_buffer = presented_buffer_;
+    const Coord overlap = {(std::min)(size.X, window_size_.X),
+                           (std::min)(size.Y, window_size_.Y)};
+    for (SHORT y = 0; y < overlap.Y; ++y)
     {
-        memory_output_ = ::CreateConsoleScreenBuffer(GENERIC_READ | GENERIC_WRITE, 
-            0, nullptr, CONSOLE_TEXTMODE_BUFFER, nullptr);
-        if (memory_output_ == INVALID_HANDLE_VALUE)
-            return false;
+        const CHAR_INFO* line = &frame_buffer_[y * window_size_.X];
+        std::copy(line, line + overlap.X, &frame_buffer[y * size.X]);
     }
-    
-    // resize console screen buffer
-    Coord window_size = GetConsoleBufferInfoEX(window_output_).dwSize;
-    Coord memory_size = GetConsoleBufferInfoEX(memory_output_).dwSize;
-    if (memory_size != window_size)
+
+    frame_buffer_.swap(frame_buffer);
+    dirty_spans_.assign(size.Y, kCleanSpan);
+    dirty_lines_ = kCleanSpan;
+}
+
+void Console::InvalidateFrameRegion(const Rect& region)
+{
+    for (SHORT y = region.Top; y <= region.Bottom; ++y)
     {
-        if (!ResizeConsoleBuffer(memory_output_, window_size))
-            return false;
+        CoordRange& span = dirty_spans_[y];
+        span.first  = (std::min)(span.first,  region.Left);
+        span.second = (std::max)(span.second, region.Right);
     }
 
-    return true;
+    dirty_lines_.first  = (std::min)(dirty_lines_.first,  region.Top);
+    dirty_lines_.second = (std::max)(dirty_lines_.second, region.Bottom);
+
+    if (!double_buffer_)
+    {
+        PresentFrameBuffer();
+    }
 }
 
-void Console::DestroyDoubleBuffer()
+void Console::PresentFrameBuffer()
 {
-    if (memory_output_ != INVALID_HANDLE_VALUE)
+    if (dirty_lines_.first > dirty_lines_.second)
+        return;
+
+    for (SHORT y = dirty_lines_.first; y <= dirty_lines_.second; ++y)
     {
-        ::CloseHandle(memory_output_);
-        memory_output_ = INVALID_HANDLE_VALUE;
+        CoordRange& span = dirty_spans_[y];
+
+        for (SHORT x = span.first; x <= span.second;)
+        {
+            const CoordRange run = FindChangedRun(y, {x, span.second});
+            if (run.first > run.second) { break; }
+            PresentFrameRegion({run.first, y, run.second, y});
+            x = run.second + 1;
+        }
+
+        span = kCleanSpan;
     }
+
+    dirty_lines_ = kCleanSpan;
+
+    // count bytes sent to console for this frame.
+    present_stats_.last_frame_bytes = backend_->FlushOutput();
+    if (present_stats_.last_frame_bytes > 0)
+    {
+        present_stats_.num_frames += 1;
+        present_stats_.num_bytes += present_stats_.last_frame_bytes;
+    }
+}
+
+Console::CoordRange Console::FindChangedRun(SHORT y, const CoordRange& xrange) const
+{
+    const CHAR_INFO* frame = &frame_buffer_[y * window_size_.X];
+    const CHAR_INFO* presented = &presented_buffer_[y * window_size_.X];
+    CoordRange run = kCleanSpan;
+
+    // find first and last changed cells, stop at a long enough unchanged gap.
+    // unchanged cells in a shorter gap are written along with changed cells
+    // around them, since that costs less than one more write.
+    const SHORT max_gap = backend_->MaxUnchangedGap();
+    for (SHORT x = xrange.first; x <= xrange.second; ++x)
+    {
+        if (!IsSameCharInfo(frame[x], presented[x]))
+        {
+            if (run.first <= run.second && x - run.second > max_gap) { break; }
+            run.first  = (std::min)(run.first, x);
+            run.second = x;
+        }
+    }
+
+    // don't split the leading byte and trailing byte of a wide character.
+    if (run.first <= run.second)
+    {
+        if (run.first > 0 && (frame[run.first].Attributes & COMMON_LVB_TRAILING_BYTE))
+        {
+            run.first -= 1;
+        }
+        if (run.second + 1 < window_size_.X &&
+            (frame[run.second].Attributes & COMMON_LVB_LEADING_BYTE))
+        {
+            run.second += 1;
+        }
+    }
+
+    return run;
+}
+
+void Console::PresentFrameRegion(const Rect& region)
+{
+    // keep what will be showed on console for later comparison.
+    for (SHORT y = region.Top; y <= region.Bottom; ++y)
+    {
+        const std::size_t offset = y * window_size_.X + region.Left;
+        std::copy_n(&frame_buffer_[offset], region.Width(), &presented_buffer_[offset]);
+    }
+
+    // write char infos to console from frame buffer directly.
+    backend_->WriteOutput(frame_buffer_.data(), window_size_, region);
+    present_stats_.num_cells += region.Width() * region.Height();
+    present_stats_.num_spans += 1;
 }
 
 Console& GConsole()
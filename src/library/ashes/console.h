@@ -1,9 +1,17 @@
 ﻿//==============================================================================
 // Console: 
 // 
-// Console is a wrap class of windows console apis.
+// Console is a wrap class of console apis, the real console is owned by a
+// ConsoleBackend: windows console on Windows, VT terminal on other platforms,
+// or a headless null backend if environment variable ASHES_CONSOLE=null, or
+// any backend installed by SetBackend before the console is first used.
 // If use that class, you should't use windows console apis yet!
 //
+// All draw functions modify an in-process frame buffer only, the real console
+// is touched when the frame buffer is presented: immediately after each draw
+// call by default, or once per FlushDoubleBuffer if double buffer is enabled.
+// Only the cells changed since last present are written to the console.
+//
 // The coordinate system is about screen space, the unit is not character!
 //   we use character width to refer the occupied screen width of a character.
 //   we always think the width of ascii character is 1, and others is 2.
@@ -13,13 +21,17 @@
 #ifndef ASHES_CONSOLE_H
 #define ASHES_CONSOLE_H
 
+#include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <utility>
-#include <windows.h>
+#include "platform.h"
 #include "rect.h"
 #include "coord.h"
 #include "graph.h"
+#include "time.h"
+#include "consolebackend.h"
 
 namespace ashes {
 
@@ -29,10 +41,23 @@ class Console
 
 public:
 
+    // install the backend of the console before GConsole is first called,
+    // return false if the console is created already.
+    static bool SetBackend(std::unique_ptr<ConsoleBackend> backend);
+
     // Typedefs
     typedef std::vector<String>     StringVector;
     typedef std::pair<SHORT, SHORT> CoordRange;
 
+    struct PresentStats
+    {
+        std::uint64_t num_frames = 0;        // presents which sent any byte.
+        std::uint64_t num_bytes = 0;         // bytes sent to console in total.
+        std::uint64_t num_cells = 0;         // cells written to console in total.
+        std::uint64_t num_spans = 0;         // runs of cells written in total.
+        std::size_t   last_frame_bytes = 0;  // bytes sent by last present.
+    };
+
     // Window
     Coord Size() const;
     Rect Region() const;
@@ -54,6 +79,7 @@ public:
     int CountEvent() const;
     bool ReadEvent(INPUT_RECORD& event);
     void WaitEvent(INPUT_RECORD& event);
+    bool WaitEventFor(time::Msecs timeout);
     
     // Measure
     static SHORT MeasureWidth(wchar_t ch);
@@ -75,6 +101,8 @@ public:
     bool IsDoubleBufferEnabled() const;
     bool EnableDoubleBuffer(bool enable);
     void FlushDoubleBuffer();
+    const PresentStats& GetPresentStats() const;
+    std::wstring Snapshot() const;
 
 private:
 
@@ -121,22 +149,29 @@ private:
         const CoordRange& xrange, SHORT y, WORD color);
 
     //==========================================================================
-    // Double buffer implementation
+    // Frame buffer: a CHAR_INFO for each character cell of console window.
     //==========================================================================
 
-    bool CreateDoubleBuffer();
-    void DestroyDoubleBuffer();
+    CHAR_INFO& FrameCell(SHORT x, SHORT y);
+    void SyncFrameBuffer();
+    void ResizeFrameBuffer(const Coord& size);
+    void InvalidateFrameRegion(const Rect& region);
+    void PresentFrameBuffer();
+    CoordRange FindChangedRun(SHORT y, const CoordRange& xrange) const;
+    void PresentFrameRegion(const Rect& region);
 
 private:
 
-    HANDLE input_ = INVALID_HANDLE_VALUE;          // the current input buffer
-    HANDLE output_ = INVALID_HANDLE_VALUE;         // the current output buffer
-    HANDLE window_output_ = INVALID_HANDLE_VALUE;  // the console window output buffer
-    HANDLE memory_output_ = INVALID_HANDLE_VALUE;  // the memory double output buffer
+    std::unique_ptr<ConsoleBackend> backend_;    // the real console
+    PresentStats                    present_stats_;
 
-    Coord                  window_size_;     // console window size
-    graph::Border          default_border_;  // default border used for draw functions
-    std::vector<CHAR_INFO> elem_buffer_;     // buffer used for read data
+    Coord                   window_size_;            // console window size
+    graph::Border           default_border_;         // default border used for draw functions
+    std::vector<CHAR_INFO>  frame_buffer_;           // shadow of console window output
+    std::vector<CHAR_INFO>  presented_buffer_;       // frame buffer at last present
+    std::vector<CoordRange> dirty_spans_;            // x-range modified of each line
+    CoordRange              dirty_lines_;            // y-range of lines having dirty span
+    bool                    double_buffer_ = false;  // present frame buffer on flush only
 };
 
 Console& GConsole();
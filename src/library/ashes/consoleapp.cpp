@@ -1,9 +1,18 @@
 ﻿#include "consoleapp.h"
+#include <chrono>
+#include <ostream>
+#include <algorithm>
 #include "console.h"
 
 namespace ashes {
 
 SimpleConsoleApp::SimpleConsoleApp()
+    : SimpleConsoleApp(time::GetRealClock())
+{
+}
+
+SimpleConsoleApp::SimpleConsoleApp(time::Clock& clock)
+    : clock_(clock), timer_manager_(clock)
 {
 }
 
@@ -22,14 +31,61 @@ void SimpleConsoleApp::Run()
             DealEvent(event);
         }
 
-        timer_manager_.Tick(time::Msecs(15));
+        timer_manager_.TriggerExpiredTimers();
 
         if (GConsole().IsDoubleBufferEnabled())
         {
             GConsole().FlushDoubleBuffer();
         }
+
+        // sleep until next input or next timer deadline. a virtual clock
+        // stands still while waiting, it's slept to the deadline then.
+        if (!pending_exit_ && !GConsole().WaitEventFor(timer_manager_.NextTimeout()))
+        {
+            const time::Msecs timeout = timer_manager_.NextTimeout();
+            if (timeout != time::Msecs::max())
+            {
+                clock_.Sleep(timeout);
+            }
+        }
+    }
+
+    OnUninit();
+}
+
+void SimpleConsoleApp::RunRenderBenchmark(std::size_t num_frames, std::ostream& os)
+{
+    OnInit();
+
+    // frames drawn by init aren't counted.
+    Console& console = GConsole();
+    console.FlushDoubleBuffer();
+    const Console::PresentStats first_stats = console.GetPresentStats();
+    const time::TimePoint start_time = time::Now();
+
+    for (std::size_t i = 0; i < num_frames; ++i)
+    {
+        OnBenchmarkFrame();
+
+        if (console.IsDoubleBufferEnabled())
+        {
+            console.FlushDoubleBuffer();
+        }
     }
 
+    const std::chrono::duration<double> duration = time::Now() - start_time;
+    const Console::PresentStats& last_stats = console.GetPresentStats();
+    const double frames = static_cast<double>((std::max)(num_frames, std::size_t(1)));
+    const std::uint64_t num_cells = last_stats.num_cells - first_stats.num_cells;
+    const std::uint64_t num_spans = last_stats.num_spans - first_stats.num_spans;
+    const std::uint64_t num_bytes = last_stats.num_bytes - first_stats.num_bytes;
+
+    os << "frames: " << num_frames << ", time: " << duration.count() << " s, "
+       << (duration.count() > 0.0 ? num_frames / duration.count() : 0.0) << " frames/sec\n";
+    os << "cells: " << num_cells << " (" << num_cells / frames << " per frame), "
+       << "spans: " << num_spans << " (" << num_spans / frames << " per frame), "
+       << "bytes: " << num_bytes << "\n";
+
     OnUninit();
 }
 
@@ -43,6 +99,11 @@ SimpleConsoleApp::WidgetID SimpleConsoleApp::GetFocusWidget() const
     return focus_widget_;
 }
 
+time::Clock& SimpleConsoleApp::GetClock()
+{
+    return clock_;
+}
+
 TimerManager& SimpleConsoleApp::GetTimerManager()
 {
     return timer_manager_;
@@ -1,10 +1,13 @@
 ﻿#ifndef ASHES_CONSOLEAPP_H
 #define ASHES_CONSOLEAPP_H
 
+#include <iosfwd>
 #include <string>
 #include <vector>
+#include <cstddef>
 #include <cstdint>
-#include <windows.h>
+#include "time.h"
+#include "platform.h"
 #include "timermanager.h"
 
 namespace ashes {
@@ -15,6 +18,7 @@ class SimpleConsoleApp
 public:
 
     SimpleConsoleApp();
+    explicit SimpleConsoleApp(time::Clock& clock);
     SimpleConsoleApp(const SimpleConsoleApp&) = delete;
     virtual ~SimpleConsoleApp() = 0;
     SimpleConsoleApp& operator = (const SimpleConsoleApp&) = delete;
@@ -22,15 +26,23 @@ public:
     void Run();
     void Exit();
 
+    // draw frames without events and timers, then print the time and present
+    // stats of them. install a null backend to measure rendering only.
+    void RunRenderBenchmark(std::size_t num_frames, std::ostream& os);
+
 protected:
 
     typedef std::uint32_t WidgetID;
 
     WidgetID GetFocusWidget() const;
+    time::Clock& GetClock();
     TimerManager& GetTimerManager();
 
     virtual void OnInit() {}
     virtual void OnUninit() {}
+
+    // step the app and draw a frame, for the render benchmark.
+    virtual void OnBenchmarkFrame() {}
     
     //==========================================================================
     // Event dispatch
@@ -57,6 +69,7 @@ private:
     
     bool         pending_exit_ = false;
     WidgetID     focus_widget_ = kNullWidgetID;
+    time::Clock& clock_;          // of timers, and of the app by GetClock.
     TimerManager timer_manager_;
 };
 
@@ -0,0 +1,43 @@
+﻿#include "consolebackend.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace ashes {
+
+namespace {
+
+bool IsNullBackendRequested()
+{
+#ifdef _WIN32
+    char value[8] = {};
+    DWORD length = ::GetEnvironmentVariableA("ASHES_CONSOLE", value, sizeof(value));
+    return length > 0 && length < sizeof(value) && std::strcmp(value, "null") == 0;
+#else
+    const char* value = std::getenv("ASHES_CONSOLE");
+    return value != nullptr && std::strcmp(value, "null") == 0;
+#endif
+}
+
+}
+
+std::unique_ptr<ConsoleBackend> ConsoleBackend::MakeDefaultBackend()
+{
+    if (IsNullBackendRequested())
+        return MakeNullBackend({80, 25});
+
+#ifdef _WIN32
+    return MakeWin32Backend();
+#else
+    return MakeVTBackend();
+#endif
+}
+
+ConsoleBackend::ConsoleBackend()
+{
+}
+
+ConsoleBackend::~ConsoleBackend()
+{
+}
+
+}
\ No newline at end of file
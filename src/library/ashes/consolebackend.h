@@ -0,0 +1,75 @@
+﻿//==============================================================================
+// ConsoleBackend: 
+// 
+// ConsoleBackend is the device behind ashes::Console, it owns the real console
+// window or terminal: window management, input events and character output.
+// Console draws into its frame buffer, then writes changed runs of cells to
+// the backend by WriteOutput, and finishes a frame by FlushOutput.
+//
+// The null backend has no terminal attached, it keeps written cells in memory
+// only and never waits, so rendering can be measured headless. It's selected
+// as the default backend if environment variable ASHES_CONSOLE is "null", or
+// installed by Console::SetBackend.
+//==============================================================================
+
+#ifndef ASHES_CONSOLEBACKEND_H
+#define ASHES_CONSOLEBACKEND_H
+
+#include <memory>
+#include <string>
+#include "coord.h"
+#include "graph.h"
+#include "rect.h"
+#include "time.h"
+#include "platform.h"
+
+namespace ashes {
+
+class ConsoleBackend
+{
+public:
+
+#ifdef _WIN32
+    static std::unique_ptr<ConsoleBackend> MakeWin32Backend();
+#else
+    static std::unique_ptr<ConsoleBackend> MakeVTBackend();
+#endif
+    static std::unique_ptr<ConsoleBackend> MakeNullBackend(const Coord& size);
+    static std::unique_ptr<ConsoleBackend> MakeDefaultBackend();
+
+    ConsoleBackend();
+    ConsoleBackend(const ConsoleBackend&) = delete;
+    virtual ~ConsoleBackend();
+    ConsoleBackend& operator = (const ConsoleBackend&) = delete;
+
+    // Window
+    virtual Coord Size() const = 0;
+    virtual bool Resize(const Coord& size) = 0;
+    virtual void Center() {}
+    virtual void SetUnresizable() {}
+
+    // Text
+    virtual void SetCodePage(UINT /*code_page*/) {}
+    virtual void SetFont(const std::wstring& /*face_name*/,
+        const Coord& /*size*/, UINT /*weight*/) {}
+    virtual void SetTitle(const String& /*title*/) {}
+    virtual void SetUneditable() {}
+
+    // Event: WaitEventFor blocks until an event is available or timeout,
+    // Msecs::max() means no timeout.
+    virtual int CountEvent() = 0;
+    virtual void WaitEvent(INPUT_RECORD& event) = 0;
+    virtual bool WaitEventFor(time::Msecs timeout) = 0;
+
+    // Output: read the whole screen into cells, write a region of cells,
+    // flush written cells to screen and return the number of bytes sent.
+    virtual SHORT MaxUnchangedGap() const = 0;
+    virtual void ReadOutput(CHAR_INFO* cells, const Coord& size) = 0;
+    virtual void WriteOutput(const CHAR_INFO* cells, const Coord& size,
+        const Rect& region) = 0;
+    virtual std::size_t FlushOutput() = 0;
+};
+
+}
+
+#endif
\ No newline at end of file
@@ -2,7 +2,7 @@
 #define ASHES_COORD_H
 
 #include <cmath>
-#include <windows.h>
+#include "platform.h"
 #include "direction4.h"
 
 namespace ashes {
@@ -1,5 +1,4 @@
 ﻿#include "graph.h"
-#include <tchar.h>
 #include <cassert>
 #include <algorithm>
 
@@ -83,13 +82,16 @@ String ToHalfWidthDigit(int number, int min_num_digits)
 {
     assert(number >= 0);
 
-    TCHAR buffer[10];
-    int num_digits = ::_stprintf_s(buffer, TEXT("%d"), number);
-    assert(num_digits > 0);
+    String str;
+    do
+    {
+        str += static_cast<TCHAR>('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
 
-    int str_len = (std::max)(num_digits, min_num_digits);
-    String str(str_len, '0');
-    str.replace(str_len - num_digits, num_digits, buffer);
+    int num_digits = static_cast<int>(str.size());
+    str.append((std::max)(min_num_digits - num_digits, 0), '0');
+    std::reverse(str.begin(), str.end());
 
     return str;
 }
@@ -2,7 +2,7 @@
 #define ASHES_GRAPH_H
 
 #include <string>
-#include <windows.h>
+#include "platform.h"
 
 namespace ashes {
 
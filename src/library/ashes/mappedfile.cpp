@@ -0,0 +1,218 @@
+﻿#include "mappedfile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace ashes {
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, std::size_t size)
+{
+    Close();
+
+    file_ = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER file_size;
+    file_size.QuadPart = static_cast<LONGLONG>(size);
+    if (!::SetFilePointerEx(file_, file_size, NULL, FILE_BEGIN) || !::SetEndOfFile(file_))
+    {
+        Close();
+        return false;
+    }
+
+    mapping_ = ::CreateFileMappingA(file_, NULL, PAGE_READWRITE,
+        file_size.HighPart, file_size.LowPart, NULL);
+    if (mapping_ == NULL)
+    {
+        Close();
+        return false;
+    }
+
+    data_ = static_cast<char*>(::MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (data_ == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = size;
+    return true;
+}
+
+bool MappedFile::OpenReadOnly(const std::string& path)
+{
+    Close();
+
+    file_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_ == INVALID_HANDLE_VALUE)
+        return false;
+
+    // an empty file can't be mapped.
+    LARGE_INTEGER file_size;
+    if (!::GetFileSizeEx(file_, &file_size) || file_size.QuadPart <= 0)
+    {
+        Close();
+        return false;
+    }
+
+    mapping_ = ::CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping_ == NULL)
+    {
+        Close();
+        return false;
+    }
+
+    data_ = static_cast<char*>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr)
+    {
+        ::UnmapViewOfFile(data_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    if (mapping_ != NULL)
+    {
+        ::CloseHandle(mapping_);
+        mapping_ = NULL;
+    }
+
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+        ::CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool MappedFile::Flush()
+{
+    return data_ != nullptr
+        && ::FlushViewOfFile(data_, 0)
+        && ::FlushFileBuffers(file_);
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, std::size_t size)
+{
+    Close();
+
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0)
+        return false;
+
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+    {
+        Close();
+        return false;
+    }
+
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    data_ = static_cast<char*>(data);
+    size_ = size;
+    return true;
+}
+
+bool MappedFile::OpenReadOnly(const std::string& path)
+{
+    Close();
+
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return false;
+
+    // an empty file can't be mapped.
+    struct stat file_stat;
+    if (::fstat(fd_, &file_stat) != 0 || file_stat.st_size <= 0)
+    {
+        Close();
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(file_stat.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED)
+    {
+        Close();
+        return false;
+    }
+
+    data_ = static_cast<char*>(data);
+    size_ = size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data_ != nullptr)
+    {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool MappedFile::Flush()
+{
+    return data_ != nullptr && ::msync(data_, size_, MS_SYNC) == 0;
+}
+
+#endif
+
+bool MappedFile::IsOpen() const
+{
+    return data_ != nullptr;
+}
+
+char* MappedFile::GetData() const
+{
+    return data_;
+}
+
+std::size_t MappedFile::GetSize() const
+{
+    return size_;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+﻿//==============================================================================
+// MappedFile:
+//
+// MappedFile maps a whole file into memory for reading and writing, so data
+// larger than memory can be used as an array, the system pages it in and out.
+// The file is created if it doesn't exist, and resized to the given size, new
+// bytes are zero. Flush writes dirty pages back to the file.
+// OpenReadOnly maps a whole existing file for reading only, the data must not
+// be written then.
+//==============================================================================
+
+#ifndef ASHES_MAPPEDFILE_H
+#define ASHES_MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include "platform.h"
+
+namespace ashes {
+
+class MappedFile
+{
+public:
+
+    MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile();
+    MappedFile& operator = (const MappedFile&) = delete;
+
+    bool Open(const std::string& path, std::size_t size);
+    bool OpenReadOnly(const std::string& path);
+    void Close();
+    bool Flush();
+
+    bool IsOpen() const;
+    char* GetData() const;
+    std::size_t GetSize() const;
+
+private:
+
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = NULL;
+#else
+    int fd_ = -1;
+#endif
+    char*       data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}
+
+#endif
\ No newline at end of file
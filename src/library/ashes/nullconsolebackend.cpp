@@ -0,0 +1,131 @@
+﻿#include "consolebackend.h"
+#include <vector>
+#include <cassert>
+#include <algorithm>
+
+namespace ashes {
+
+//==============================================================================
+// ConsoleBackend - Null
+//==============================================================================
+
+class NullConsoleBackend : public ConsoleBackend
+{
+public:
+
+    explicit NullConsoleBackend(const Coord& size);
+
+    Coord Size() const override;
+    bool Resize(const Coord& size) override;
+
+    int CountEvent() override;
+    void WaitEvent(INPUT_RECORD& event) override;
+    bool WaitEventFor(time::Msecs timeout) override;
+
+    SHORT MaxUnchangedGap() const override;
+    void ReadOutput(CHAR_INFO* cells, const Coord& size) override;
+    void WriteOutput(const CHAR_INFO* cells, const Coord& size, const Rect& region) override;
+    std::size_t FlushOutput() override;
+
+private:
+
+    Coord                  size_;                   // screen size in cells
+    std::vector<CHAR_INFO> cells_;                  // cells of screen
+    std::size_t            num_written_bytes_ = 0;  // bytes written since last flush
+};
+
+NullConsoleBackend::NullConsoleBackend(const Coord& size)
+{
+    CHAR_INFO blank = {};
+    blank.Char.UnicodeChar = L' ';
+    blank.Attributes = 0x07;
+
+    size_ = size;
+    cells_.assign(size.X * size.Y, blank);
+}
+
+Coord NullConsoleBackend::Size() const
+{
+    return size_;
+}
+
+bool NullConsoleBackend::Resize(const Coord& size)
+{
+    CHAR_INFO blank = {};
+    blank.Char.UnicodeChar = L' ';
+    blank.Attributes = 0x07;
+    std::vector<CHAR_INFO> cells(size.X * size.Y, blank);
+
+    // keep cells inside the overlapped region, just like console does.
+    const Coord overlap = {(std::min)(size.X, size_.X), (std::min)(size.Y, size_.Y)};
+    for (SHORT y = 0; y < overlap.Y; ++y)
+    {
+        const CHAR_INFO* line = &cells_[y * size_.X];
+        std::copy(line, line + overlap.X, &cells[y * size.X]);
+    }
+
+    size_ = size;
+    cells_.swap(cells);
+    return true;
+}
+
+int NullConsoleBackend::CountEvent()
+{
+    return 0;
+}
+
+void NullConsoleBackend::WaitEvent(INPUT_RECORD& /*event*/)
+{
+    // no input device, CountEvent never reports any event.
+    assert(false);
+}
+
+bool NullConsoleBackend::WaitEventFor(time::Msecs /*timeout*/)
+{
+    // no event ever comes, return at once so that headless frames aren't
+    // paced by the real clock.
+    return false;
+}
+
+SHORT NullConsoleBackend::MaxUnchangedGap() const
+{
+    // a write is a memory copy, gaps cost as much as separated runs.
+    return 0;
+}
+
+void NullConsoleBackend::ReadOutput(CHAR_INFO* cells, const Coord& size)
+{
+    assert(size.X == size_.X && size.Y == size_.Y);
+    std::copy(cells_.cbegin(), cells_.cend(), cells);
+}
+
+void NullConsoleBackend::WriteOutput(
+    const CHAR_INFO* cells,
+    const Coord& size,
+    const Rect& region)
+{
+    for (SHORT y = region.Top; y <= region.Bottom; ++y)
+    {
+        std::copy_n(&cells[y * size.X + region.Left], region.Width(),
+            &cells_[y * size_.X + region.Left]);
+    }
+    num_written_bytes_ += region.Width() * region.Height() * sizeof(CHAR_INFO);
+}
+
+std::size_t NullConsoleBackend::FlushOutput()
+{
+    std::size_t num_bytes = num_written_bytes_;
+    num_written_bytes_ = 0;
+    return num_bytes;
+}
+
+//==============================================================================
+// ConsoleBackend - Interface
+//==============================================================================
+
+std::unique_ptr<ConsoleBackend> ConsoleBackend::MakeNullBackend(const Coord& size)
+{
+    return std::make_unique<NullConsoleBackend>(size);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+﻿//==============================================================================
+// Platform: 
+// 
+// Include <windows.h> on Windows. on other platforms, define the subset of
+// windows types, macros and constants which are used by ashes and games, so
+// the code based on ashes keeps the same source on all platforms.
+// TCHAR is always char on other platforms, all strings are encoded in UTF-8.
+//==============================================================================
+
+#ifndef ASHES_PLATFORM_H
+#define ASHES_PLATFORM_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+#else
+
+#include <cstdint>
+
+// Basic types
+typedef std::int16_t  SHORT;
+typedef std::uint16_t WORD;
+typedef std::uint32_t DWORD;
+typedef std::int32_t  LONG;
+typedef unsigned int  UINT;
+typedef int           BOOL;
+typedef char          CHAR;
+typedef wchar_t       WCHAR;
+typedef char          TCHAR;
+
+#define TRUE  1
+#define FALSE 0
+#define TEXT(str) str
+
+// Console types
+struct COORD
+{
+    SHORT X;
+    SHORT Y;
+};
+
+struct SMALL_RECT
+{
+    SHORT Left;
+    SHORT Top;
+    SHORT Right;
+    SHORT Bottom;
+};
+
+struct CHAR_INFO
+{
+    union { WCHAR UnicodeChar; CHAR AsciiChar; } Char;
+    WORD Attributes;
+};
+
+struct KEY_EVENT_RECORD
+{
+    BOOL  bKeyDown;
+    WORD  wRepeatCount;
+    WORD  wVirtualKeyCode;
+    WORD  wVirtualScanCode;
+    union { WCHAR UnicodeChar; CHAR AsciiChar; } uChar;
+    DWORD dwControlKeyState;
+};
+
+struct MOUSE_EVENT_RECORD
+{
+    COORD dwMousePosition;
+    DWORD dwButtonState;
+    DWORD dwControlKeyState;
+    DWORD dwEventFlags;
+};
+
+struct INPUT_RECORD
+{
+    WORD EventType;
+    union { KEY_EVENT_RECORD KeyEvent; MOUSE_EVENT_RECORD MouseEvent; } Event;
+};
+
+#define COMMON_LVB_LEADING_BYTE      0x0100
+#define COMMON_LVB_TRAILING_BYTE     0x0200
+#define KEY_EVENT                    0x0001
+#define MOUSE_EVENT                  0x0002
+#define MOUSE_MOVED                  0x0001
+#define FROM_LEFT_1ST_BUTTON_PRESSED 0x0001
+#define CP_UTF8                      65001
+
+// Virtual keys
+#define VK_BACK    0x08
+#define VK_TAB     0x09
+#define VK_RETURN  0x0D
+#define VK_CONTROL 0x11
+#define VK_ESCAPE  0x1B
+#define VK_SPACE   0x20
+#define VK_LEFT    0x25
+#define VK_UP      0x26
+#define VK_RIGHT   0x27
+#define VK_DOWN    0x28
+
+// Macros
+#define MAKELONG(a, b) ((LONG)(((WORD)(a)) | ((DWORD)((WORD)(b))) << 16))
+#define LOWORD(l)      ((WORD)(((DWORD)(l)) & 0xFFFF))
+#define HIWORD(l)      ((WORD)((((DWORD)(l)) >> 16) & 0xFFFF))
+
+#endif
+
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define ASHES_RANDOM_H
 
 #include <ctime>
+#include <cassert>
 #include <random>
 #include <type_traits>
 
@@ -22,6 +23,29 @@ inline int IntRange(int a, int b)
     return static_cast<int>(Uniform() * (b - a) + 0.5f) + a;
 }
 
+// uniform in [0, size), rand() is called twice a draw if RAND_MAX is less
+// than size. draws beyond the last whole multiple of size are drawn again, so
+// every index is equally likely.
+inline int Index(int size)
+{
+    const unsigned long long range = RAND_MAX + 1ull;
+    const unsigned long long limit = (size > RAND_MAX ? range * range : range);
+    assert(0 < size && static_cast<unsigned long long>(size) <= limit);
+    const unsigned long long last = limit - limit % static_cast<unsigned long long>(size);
+
+    unsigned long long r = 0;
+    do
+    {
+        r = static_cast<unsigned long long>(std::rand());
+        if (size > RAND_MAX)
+        {
+            r = r * range + static_cast<unsigned long long>(std::rand());
+        }
+    } while (r >= last);
+
+    return static_cast<int>(r % static_cast<unsigned long long>(size));
+}
+
 inline bool Bool()
 {
     return (std::rand() & 1) == 1;
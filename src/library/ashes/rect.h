@@ -2,7 +2,7 @@
 #define ASHES_RECT_H
 
 #include <algorithm>
-#include <windows.h>
+#include "platform.h"
 #include "coord.h"
 
 namespace ashes {
@@ -49,7 +49,9 @@ inline Rect::Rect(const SMALL_RECT& rect)
 }
 
 inline Rect::Rect(const Coord& point, const Coord& size)
-    : SMALL_RECT({point.X, point.Y, point.X + size.X - 1, point.Y + size.Y - 1})
+    : SMALL_RECT({point.X, point.Y,
+        static_cast<SHORT>(point.X + size.X - 1),
+        static_cast<SHORT>(point.Y + size.Y - 1)})
 {
 }
 
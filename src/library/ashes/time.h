@@ -6,13 +6,13 @@
 
 namespace ashes { namespace time {
 
-typedef std::chrono::steady_clock Clock;
-typedef Clock::time_point         TimePoint;
+typedef std::chrono::steady_clock SteadyClock;
+typedef SteadyClock::time_point   TimePoint;
 typedef std::chrono::milliseconds Msecs;
 
 inline TimePoint Now()
 {
-    return Clock::now();
+    return SteadyClock::now();
 }
 
 inline Msecs MsecsBetween(TimePoint from, TimePoint to)
@@ -30,11 +30,65 @@ inline Msecs MsecsTo(TimePoint t)
     return MsecsBetween(Now(), t);
 }
 
+// rounded up milliseconds from now to t, zero if t is passed.
+inline Msecs MsecsUntil(TimePoint t, TimePoint now)
+{
+    const SteadyClock::duration duration = t - now;
+    if (duration <= SteadyClock::duration::zero())
+        return Msecs::zero();
+
+    const Msecs msecs = std::chrono::duration_cast<Msecs>(duration);
+    return msecs < duration ? msecs + Msecs(1) : msecs;
+}
+
+inline Msecs MsecsUntil(TimePoint t)
+{
+    return MsecsUntil(t, Now());
+}
+
 inline void Sleep(Msecs msecs)
 {
     std::this_thread::sleep_for(msecs);
 }
 
+//==============================================================================
+// Clock: the source of time which can be injected into timing code.
+//   RealClock reads steady clock and sleeps current thread.
+//   VirtualClock stands still until it sleeps, then jumps to the wake up time
+//   instantly, so simulations run as fast as possible and reproducibly.
+//==============================================================================
+
+class Clock
+{
+public:
+    virtual ~Clock() {}
+    virtual TimePoint Now() const = 0;
+    virtual void Sleep(Msecs msecs) = 0;
+};
+
+class RealClock : public Clock
+{
+public:
+    TimePoint Now() const override { return time::Now(); }
+    void Sleep(Msecs msecs) override { time::Sleep(msecs); }
+};
+
+class VirtualClock : public Clock
+{
+public:
+    explicit VirtualClock(TimePoint start = TimePoint()) : now_(start) {}
+    TimePoint Now() const override { return now_; }
+    void Sleep(Msecs msecs) override { if (msecs > Msecs::zero()) { now_ += msecs; } }
+private:
+    TimePoint now_;
+};
+
+inline Clock& GetRealClock()
+{
+    static RealClock clock;
+    return clock;
+}
+
 }}
 
 #endif
\ No newline at end of file
@@ -4,7 +4,25 @@
 
 namespace ashes {
 
+namespace {
+
+// deadline after period from now, saturated for a very long period.
+time::TimePoint MakeDeadline(time::TimePoint now, time::Msecs period)
+{
+    const time::Msecs max_period = std::chrono::duration_cast<time::Msecs>(
+        time::TimePoint::max() - now);
+    return period >= max_period ? time::TimePoint::max() : now + period;
+}
+
+}
+
 TimerManager::TimerManager()
+    : TimerManager(time::GetRealClock())
+{
+}
+
+TimerManager::TimerManager(time::Clock& clock)
+    : clock_(clock)
 {
 }
 
@@ -13,15 +31,30 @@ TimerManager::~TimerManager()
 }
 
 TimerHandle TimerManager::NewTimer1(
-    TimerEvent1 event, 
+    TimerEvent1 event,
     time::Msecs period,
     bool loop)
 {
-    UniqueTimer timer = AllocateTimer();
-    TimerHandle handle = timer->Handle();
-    timer->Init(std::move(event), period, loop);
-    active_timers_.push_back(std::move(timer));
-    return handle;
+    std::uint32_t slot = 0;
+    if (!free_slots_.empty())
+    {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else
+    {
+        slot = static_cast<std::uint32_t>(timers_.size());
+        timers_.emplace_back();
+    }
+
+    Timer& timer = timers_[slot];
+    timer.event = std::move(event);
+    timer.period = period;
+    timer.deadline = MakeDeadline(clock_.Now(), period);
+    timer.loop = loop;
+    PushHeap(slot);
+
+    return {slot, timer.generation};
 }
 
 TimerHandle TimerManager::NewTimer2(
@@ -38,19 +71,30 @@ void TimerManager::SetTimer(
     time::Msecs period,
     bool loop)
 {
-    if (UniqueTimer* timer = FindTimer(handle))
+    if (Timer* timer = FindTimer(handle))
     {
-        (*timer)->Modify(period, loop);
+        timer->period = period;
+        timer->deadline = MakeDeadline(clock_.Now(), period);
+        timer->loop = loop;
+
+        // a triggering timer is rescheduled after its event returns.
+        if (timer->heap_index != kNotInHeap)
+        {
+            SiftUp(timer->heap_index);
+            SiftDown(timer->heap_index);
+        }
     }
 }
 
 void TimerManager::KillTimer(TimerHandle handle)
 {
-    if (UniqueTimer* timer = FindTimer(handle))
+    if (Timer* timer = FindTimer(handle))
     {
-        std::size_t index = timer - active_timers_.data();
-        DeallocateTimer(std::move(*timer));
-        active_timers_.erase(active_timers_.begin() + index);
+        if (timer->heap_index != kNotInHeap)
+        {
+            RemoveHeap(timer->heap_index);
+        }
+        FreeTimer(handle.slot_);
     }
 }
 
@@ -62,98 +106,164 @@ void TimerManager::InvalidateTimer(TimerHandle& handle)
 
 void TimerManager::Tick(time::Msecs timeslice)
 {
-    while (UniqueTimer* timer_ptr = FindEarliestTimer())
+    const time::TimePoint end_time = MakeDeadline(clock_.Now(), timeslice);
+
+    // trigger timers within timeslice, sleep until next deadline between them.
+    for (;;)
+    {
+        TriggerExpiredTimers();
+
+        const time::Msecs remaining_time = time::MsecsUntil(end_time, clock_.Now());
+        if (remaining_time == time::Msecs::zero()) { break; }
+        clock_.Sleep((std::min)(NextTimeout(), remaining_time));
+    }
+}
+
+void TimerManager::TriggerExpiredTimers()
+{
+    const time::TimePoint now = clock_.Now();
+
+    // take expired timers out of heap first, so a timer rescheduled by its
+    // event is triggered at next call, even if its period is zero.
+    expired_timers_.clear();
+    while (!heap_.empty() && timers_[heap_.front()].deadline <= now)
     {
-        assert(*timer_ptr != nullptr);
-        Timer& timer = **timer_ptr;
-        
-        // wait timer within timeslice.
-        time::Msecs remaining_time = timer.RemainingTime();
-        if (remaining_time > time::Msecs::zero())
+        const std::uint32_t slot = heap_.front();
+        expired_timers_.push_back({slot, timers_[slot].generation});
+        RemoveHeap(0);
+    }
+
+    std::vector<TimerHandle> expired_timers;
+    expired_timers.swap(expired_timers_);
+
+    for (const TimerHandle& handle : expired_timers)
+    {
+        // skip timers killed or modified by former events.
+        Timer* timer_ptr = FindTimer(handle);
+        if (timer_ptr == nullptr)
+            continue;
+
+        if (timer_ptr->deadline > now)
         {
-            if (timeslice < remaining_time) { break; }
-            time::Sleep(remaining_time);
-            timeslice -= remaining_time;
+            PushHeap(handle.slot_);
+            continue;
         }
 
-        // trigger timer.
-        if (!timer.Trigger())
+        // event may create or kill timers, so keep it out of timers_.
+        TimerEvent1 event = std::move(timer_ptr->event);
+        const bool keep_loop = event();
+
+        Timer& timer = timers_[handle.slot_];
+        if (timer.generation != handle.generation_)
+            continue;
+
+        if (keep_loop && timer.loop)
         {
-            KillTimer(timer.Handle());
+            timer.event = std::move(event);
+            timer.deadline = MakeDeadline(clock_.Now(), timer.period);
+            PushHeap(handle.slot_);
+        }
+        else
+        {
+            FreeTimer(handle.slot_);
         }
     }
 
-    time::Sleep(timeslice);
+    // keep capacity of the buffer for next call.
+    expired_timers.clear();
+    expired_timers_.swap(expired_timers);
 }
 
-TimerManager::UniqueTimer* TimerManager::FindTimer(TimerHandle handle)
+time::Msecs TimerManager::NextTimeout()
 {
-    auto iter = std::find_if(active_timers_.begin(), active_timers_.end(),
-        [handle](const UniqueTimer& timer) { return timer->Handle() == handle; });
-    return iter == active_timers_.end() ? nullptr : &*iter;
+    return heap_.empty() ? time::Msecs::max()
+        : time::MsecsUntil(timers_[heap_.front()].deadline, clock_.Now());
 }
 
-TimerManager::UniqueTimer* TimerManager::FindEarliestTimer()
+TimerManager::Timer* TimerManager::FindTimer(TimerHandle handle)
 {
-    auto iter = std::min_element(active_timers_.begin(), active_timers_.end(),
-        [](const UniqueTimer& x, const UniqueTimer& y) {
-            return x->RemainingTime() < y->RemainingTime(); });
-    return iter == active_timers_.end() ? nullptr : &*iter;
-}
-
-TimerManager::UniqueTimer TimerManager::AllocateTimer()
-{
-    if (!dead_timers_.empty())
+    if (handle.slot_ < timers_.size() &&
+        timers_[handle.slot_].generation == handle.generation_)
     {
-        UniqueTimer timer = std::move(dead_timers_.back());
-        dead_timers_.pop_back();
-        return timer;
+        return &timers_[handle.slot_];
     }
-    return std::make_unique<Timer>();
+    return nullptr;
 }
 
-void TimerManager::DeallocateTimer(UniqueTimer timer)
+void TimerManager::FreeTimer(std::uint32_t slot)
 {
-    dead_timers_.push_back(std::move(timer));
+    Timer& timer = timers_[slot];
+    assert(timer.heap_index == kNotInHeap);
+
+    // skip generation 0 which is used by null handle.
+    timer.event = nullptr;
+    timer.generation = (timer.generation + 1 == 0 ? 1 : timer.generation + 1);
+    free_slots_.push_back(slot);
 }
 
-void TimerManager::Timer::Init(
-    TimerEvent1 event,
-    time::Msecs period,
-    bool loop)
+bool TimerManager::IsEarlier(std::size_t index1, std::size_t index2) const
 {
-    event_ = std::move(event);
-    Modify(period, loop);
-    RefreshLastTime();
+    return timers_[heap_[index1]].deadline < timers_[heap_[index2]].deadline;
 }
 
-TimerHandle TimerManager::Timer::Handle() const
+void TimerManager::SwapHeapNodes(std::size_t index1, std::size_t index2)
 {
-    return this;
+    std::swap(heap_[index1], heap_[index2]);
+    timers_[heap_[index1]].heap_index = index1;
+    timers_[heap_[index2]].heap_index = index2;
 }
 
-time::Msecs TimerManager::Timer::RemainingTime() const
+void TimerManager::SiftUp(std::size_t index)
 {
-    time::Msecs elapse = time::MsecsFrom(last_time_);
-    return elapse >= period_ ? time::Msecs::zero() : period_ - elapse;
+    while (index > 0)
+    {
+        const std::size_t parent = (index - 1) / 2;
+        if (!IsEarlier(index, parent)) { break; }
+        SwapHeapNodes(index, parent);
+        index = parent;
+    }
 }
 
-void TimerManager::Timer::Modify(time::Msecs period, bool loop)
+void TimerManager::SiftDown(std::size_t index)
 {
-    period_ = period;
-    loop_ = loop;
+    for (;;)
+    {
+        const std::size_t left = index * 2 + 1;
+        const std::size_t right = left + 1;
+        std::size_t earliest = index;
+
+        if (left < heap_.size() && IsEarlier(left, earliest)) { earliest = left; }
+        if (right < heap_.size() && IsEarlier(right, earliest)) { earliest = right; }
+        if (earliest == index) { break; }
+
+        SwapHeapNodes(index, earliest);
+        index = earliest;
+    }
 }
 
-void TimerManager::Timer::RefreshLastTime()
+void TimerManager::PushHeap(std::uint32_t slot)
 {
-    last_time_ = time::Now();
+    timers_[slot].heap_index = heap_.size();
+    heap_.push_back(slot);
+    SiftUp(heap_.size() - 1);
 }
 
-bool TimerManager::Timer::Trigger()
+void TimerManager::RemoveHeap(std::size_t index)
 {
-    bool keep_loop = event_();
-    RefreshLastTime();
-    return keep_loop && loop_;
+    const std::size_t last = heap_.size() - 1;
+    if (index != last)
+    {
+        SwapHeapNodes(index, last);
+    }
+
+    timers_[heap_.back()].heap_index = kNotInHeap;
+    heap_.pop_back();
+
+    if (index < heap_.size())
+    {
+        SiftUp(index);
+        SiftDown(index);
+    }
 }
 
 }
\ No newline at end of file
@@ -1,22 +1,49 @@
 ﻿#ifndef ASHES_TIMERMANAGER_H
 #define ASHES_TIMERMANAGER_H
 
-#include <memory>
 #include <vector>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include "time.h"
 
 namespace ashes {
 
-typedef const void*           TimerHandle;  // use nullptr as a null timer handle.
+// TimerHandle refers a timer by its slot and the generation of the slot, so a
+// handle of a killed timer never refers a new timer reusing the same slot.
+// use nullptr as a null timer handle.
+class TimerHandle
+{
+    friend class TimerManager;
+
+public:
+
+    TimerHandle() = default;
+    TimerHandle(std::nullptr_t) {}
+
+    bool operator == (const TimerHandle& other) const;
+    bool operator != (const TimerHandle& other) const;
+
+private:
+
+    TimerHandle(std::uint32_t slot, std::uint32_t generation);
+
+    std::uint32_t slot_ = 0;
+    std::uint32_t generation_ = 0;  // generation of null handle is 0.
+};
+
 typedef std::function<bool()> TimerEvent1;  // return false indicate kill the timer.
 typedef std::function<void()> TimerEvent2;  // return value is ignored.
 
+// TimerManager keeps timers in a binary min-heap keyed by absolute deadline,
+// and finds a timer by its handle in constant time. Time is read from the
+// injected clock, which is the real clock by default.
 class TimerManager
 {
 public:
 
     TimerManager();
+    explicit TimerManager(time::Clock& clock);
     TimerManager(const TimerManager&) = delete;
     ~TimerManager();
     TimerManager& operator = (const TimerManager&) = delete;
@@ -28,39 +55,54 @@ public:
     void InvalidateTimer(TimerHandle& handle);
 
     void Tick(time::Msecs timeslice);
+    void TriggerExpiredTimers();
+    time::Msecs NextTimeout();  // Msecs::max() if there is no timer.
 
 private:
 
-    class Timer
+    static const std::size_t kNotInHeap = SIZE_MAX;
+
+    struct Timer
     {
-    public:
-        void Init(TimerEvent1 event, time::Msecs period, bool loop);
-        TimerHandle Handle() const;
-        time::Msecs RemainingTime() const;
-        void Modify(time::Msecs period, bool loop);
-        void RefreshLastTime();
-        bool Trigger();
-    private:
-        TimerEvent1     event_;
-        time::Msecs     period_;
-        bool            loop_;
-        time::TimePoint last_time_;
+        TimerEvent1     event;
+        time::Msecs     period;
+        time::TimePoint deadline;
+        std::size_t     heap_index = kNotInHeap;  // not in heap while triggering.
+        std::uint32_t   generation = 1;           // bumped when the timer is killed.
+        bool            loop = false;
     };
 
-private:
-
-    typedef std::unique_ptr<Timer>   UniqueTimer;
-    typedef std::vector<UniqueTimer> TimerVector;
+    Timer* FindTimer(TimerHandle handle);
+    void FreeTimer(std::uint32_t slot);
+
+    bool IsEarlier(std::size_t index1, std::size_t index2) const;
+    void SwapHeapNodes(std::size_t index1, std::size_t index2);
+    void SiftUp(std::size_t index);
+    void SiftDown(std::size_t index);
+    void PushHeap(std::uint32_t slot);
+    void RemoveHeap(std::size_t index);
+
+    time::Clock&               clock_;           // source of time
+    std::vector<Timer>         timers_;          // timers indexed by slot
+    std::vector<std::uint32_t> free_slots_;      // slots of killed timers
+    std::vector<std::uint32_t> heap_;            // slots ordered by deadline
+    std::vector<TimerHandle>   expired_timers_;  // buffer of expired timers
+};
 
-    UniqueTimer* FindTimer(TimerHandle handle);
-    UniqueTimer* FindEarliestTimer();
+inline bool TimerHandle::operator == (const TimerHandle& other) const
+{
+    return slot_ == other.slot_ && generation_ == other.generation_;
+}
 
-    UniqueTimer AllocateTimer();
-    void DeallocateTimer(UniqueTimer timer);
+inline bool TimerHandle::operator != (const TimerHandle& other) const
+{
+    return !(*this == other);
+}
 
-    TimerVector active_timers_;
-    TimerVector dead_timers_;
-};
+inline TimerHandle::TimerHandle(std::uint32_t slot, std::uint32_t generation)
+    : slot_(slot), generation_(generation)
+{
+}
 
 }
 
@@ -0,0 +1,533 @@
+﻿#ifndef _WIN32
+
+#include "consolebackend.h"
+#include <deque>
+#include <cerrno>
+#include <cassert>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <algorithm>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include "winapi.h"
+
+namespace ashes {
+
+namespace {
+
+// alternate screen, hidden cursor, any-motion mouse tracking in SGR format.
+const char kEnterSequence[] = "\x1b[?1049h\x1b[?25l\x1b[?1003h\x1b[?1006h";
+const char kLeaveSequence[] = "\x1b[?1006l\x1b[?1003l\x1b[?25h\x1b[0m\x1b[?1049l";
+
+const SHORT kUnknownPos = -1;
+const int   kUnknownColor = -1;
+
+// terminal state to restore at exit, shared with the signal handler.
+termios g_saved_termios;
+bool    g_terminal_entered = false;
+
+void WriteAll(int fd, const char* data, std::size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR) { continue; }
+            break;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+}
+
+void LeaveTerminal()
+{
+    if (g_terminal_entered)
+    {
+        WriteAll(STDOUT_FILENO, kLeaveSequence, sizeof(kLeaveSequence) - 1);
+        ::tcsetattr(STDIN_FILENO, TCSAFLUSH, &g_saved_termios);
+        g_terminal_entered = false;
+    }
+}
+
+void OnTerminateSignal(int sig)
+{
+    LeaveTerminal();
+    std::signal(sig, SIG_DFL);
+    std::raise(sig);
+}
+
+void EnterTerminal()
+{
+    if (::tcgetattr(STDIN_FILENO, &g_saved_termios) != 0)
+        return;
+
+    // raw input without echo, keep signals for ctrl+c.
+    termios raw = g_saved_termios;
+    raw.c_iflag &= ~(IXON | ICRNL);
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    ::tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+
+    WriteAll(STDOUT_FILENO, kEnterSequence, sizeof(kEnterSequence) - 1);
+    g_terminal_entered = true;
+
+    std::signal(SIGINT, OnTerminateSignal);
+    std::signal(SIGTERM, OnTerminateSignal);
+    std::signal(SIGHUP, OnTerminateSignal);
+}
+
+// windows color bits are BGR, ansi color bits are RGB.
+int ToAnsiColor(WORD color)
+{
+    return ((color & 0x1) << 2) | (color & 0x2) | ((color & 0x4) >> 2);
+}
+
+// characters which are showed in 2 columns by terminals.
+bool IsWideChar(wchar_t ch)
+{
+    const unsigned int code = static_cast<unsigned int>(ch);
+    return (code >= 0x1100 && code <= 0x115F) ||
+           (code >= 0x2E80 && code <= 0xA4CF) ||
+           (code >= 0xAC00 && code <= 0xD7A3) ||
+           (code >= 0xF900 && code <= 0xFAFF) ||
+           (code >= 0xFE30 && code <= 0xFE4F) ||
+           (code >= 0xFF00 && code <= 0xFF60) ||
+           (code >= 0xFFE0 && code <= 0xFFE6);
+}
+
+INPUT_RECORD MakeKeyEvent(WORD key, wchar_t ch, bool pressed)
+{
+    INPUT_RECORD event = {};
+    event.EventType = KEY_EVENT;
+    event.Event.KeyEvent.bKeyDown = pressed ? TRUE : FALSE;
+    event.Event.KeyEvent.wRepeatCount = 1;
+    event.Event.KeyEvent.wVirtualKeyCode = key;
+    event.Event.KeyEvent.uChar.UnicodeChar = ch;
+    return event;
+}
+
+INPUT_RECORD MakeMouseEvent(SHORT x, SHORT y, DWORD button_state, DWORD flags)
+{
+    INPUT_RECORD event = {};
+    event.EventType = MOUSE_EVENT;
+    event.Event.MouseEvent.dwMousePosition = {x, y};
+    event.Event.MouseEvent.dwButtonState = button_state;
+    event.Event.MouseEvent.dwEventFlags = flags;
+    return event;
+}
+
+}
+
+//==============================================================================
+// ConsoleBackend - VT
+//==============================================================================
+
+// VTConsoleBackend drives a terminal by ANSI/VT escape sequences. written
+// cells are encoded into an output buffer with the shortest cursor movement
+// and only changed SGR color parameters, then sent by one write per frame.
+class VTConsoleBackend : public ConsoleBackend
+{
+public:
+
+    VTConsoleBackend();
+    ~VTConsoleBackend();
+
+    Coord Size() const override;
+    bool Resize(const Coord& size) override;
+
+    void SetTitle(const String& title) override;
+
+    int CountEvent() override;
+    void WaitEvent(INPUT_RECORD& event) override;
+    bool WaitEventFor(time::Msecs timeout) override;
+
+    SHORT MaxUnchangedGap() const override;
+    void ReadOutput(CHAR_INFO* cells, const Coord& size) override;
+    void WriteOutput(const CHAR_INFO* cells, const Coord& size, const Rect& region) override;
+    std::size_t FlushOutput() override;
+
+private:
+
+    void MoveCursor(SHORT x, SHORT y);
+    void SetColor(WORD color);
+    void AppendNumber(int number);
+
+    void ReadInput(int timeout);
+    void ParseInput();
+    std::size_t ParseEscape(std::size_t pos);
+    void PushKey(WORD key, wchar_t ch);
+
+private:
+
+    Coord                    size_;                     // terminal size in cells
+    Coord                    cursor_;                   // cursor position, or unknown
+    int                      fg_ = kUnknownColor;       // current foreground color
+    int                      bg_ = kUnknownColor;       // current background color
+    std::string              output_;                   // bytes to send at next flush
+    std::string              input_;                    // bytes received but not parsed
+    std::deque<INPUT_RECORD> events_;                   // parsed input events
+};
+
+VTConsoleBackend::VTConsoleBackend()
+{
+    winsize ws = {};
+    if (::ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0)
+    {
+        size_ = {static_cast<SHORT>(ws.ws_col), static_cast<SHORT>(ws.ws_row)};
+    }
+    else
+    {
+        size_ = {80, 25};
+    }
+
+    cursor_ = {kUnknownPos, kUnknownPos};
+    EnterTerminal();
+    std::atexit(LeaveTerminal);
+}
+
+VTConsoleBackend::~VTConsoleBackend()
+{
+    LeaveTerminal();
+}
+
+Coord VTConsoleBackend::Size() const
+{
+    return size_;
+}
+
+bool VTConsoleBackend::Resize(const Coord& size)
+{
+    // xterm window manipulation, terminals may ignore it.
+    output_ += "\x1b[8;";
+    AppendNumber(size.Y);
+    output_ += ';';
+    AppendNumber(size.X);
+    output_ += 't';
+    FlushOutput();
+
+    size_ = size;
+    return true;
+}
+
+void VTConsoleBackend::SetTitle(const String& title)
+{
+    output_ += "\x1b]0;";
+    output_ += title;
+    output_ += '\x07';
+    FlushOutput();
+}
+
+int VTConsoleBackend::CountEvent()
+{
+    ReadInput(0);
+    return static_cast<int>(events_.size());
+}
+
+void VTConsoleBackend::WaitEvent(INPUT_RECORD& event)
+{
+    while (events_.empty())
+    {
+        ReadInput(-1);
+    }
+
+    event = events_.front();
+    events_.pop_front();
+}
+
+bool VTConsoleBackend::WaitEventFor(time::Msecs timeout)
+{
+    // a split escape sequence may need more reads until an event is parsed.
+    for (time::TimePoint start = time::Now(); events_.empty();)
+    {
+        const time::Msecs elapse = time::MsecsFrom(start);
+        if (elapse >= timeout) { break; }
+
+        const time::Msecs remaining_time = timeout - elapse;
+        ReadInput(remaining_time.count() > INT_MAX ? -1
+            : static_cast<int>(remaining_time.count()));
+    }
+
+    return !events_.empty();
+}
+
+SHORT VTConsoleBackend::MaxUnchangedGap() const
+{
+    // a cursor forward sequence costs about as much as a few cells.
+    return 3;
+}
+
+void VTConsoleBackend::ReadOutput(CHAR_INFO* cells, const Coord& size)
+{
+    // terminal is unreadable, clear it to blanks of default color.
+    CHAR_INFO blank = {};
+    blank.Char.UnicodeChar = L' ';
+    blank.Attributes = 0x07;
+    std::fill_n(cells, size.X * size.Y, blank);
+
+    SetColor(blank.Attributes);
+    output_ += "\x1b[2J";
+    cursor_ = {kUnknownPos, kUnknownPos};
+    FlushOutput();
+}
+
+void VTConsoleBackend::WriteOutput(
+    const CHAR_INFO* cells,
+    const Coord& size,
+    const Rect& region)
+{
+    for (SHORT y = region.Top; y <= region.Bottom; ++y)
+    {
+        const CHAR_INFO* line = &cells[y * size.X];
+
+        for (SHORT x = region.Left; x <= region.Right; ++x)
+        {
+            const CHAR_INFO& ci = line[x];
+
+            // trailing byte is showed by its leading byte.
+            if (ci.Attributes & COMMON_LVB_TRAILING_BYTE)
+                continue;
+
+            MoveCursor(x, y);
+            SetColor(ci.Attributes);
+
+            const wchar_t ch = ci.Char.UnicodeChar;
+            output_ += win::W2A(&ch, 1, CP_UTF8);
+
+            SHORT width = 1;
+            if (ci.Attributes & COMMON_LVB_LEADING_BYTE)
+            {
+                // pad narrow character to 2 columns like windows console does.
+                if (!IsWideChar(ch)) { output_ += ' '; }
+                width = 2;
+            }
+
+            // cursor position is terminal dependent after last column.
+            cursor_.X += width;
+            if (cursor_.X >= size_.X) { cursor_ = {kUnknownPos, kUnknownPos}; }
+        }
+    }
+}
+
+std::size_t VTConsoleBackend::FlushOutput()
+{
+    const std::size_t num_bytes = output_.size();
+    if (num_bytes > 0)
+    {
+        WriteAll(STDOUT_FILENO, output_.data(), num_bytes);
+        output_.clear();
+    }
+    return num_bytes;
+}
+
+void VTConsoleBackend::MoveCursor(SHORT x, SHORT y)
+{
+    if (cursor_.X == x && cursor_.Y == y)
+        return;
+
+    // choose the shortest one of absolute position, forward and column.
+    const std::size_t start = output_.size();
+    output_ += "\x1b[";
+    AppendNumber(y + 1);
+    output_ += ';';
+    AppendNumber(x + 1);
+    output_ += 'H';
+
+    if (cursor_.Y == y && cursor_.X != kUnknownPos)
+    {
+        std::string absolute = output_.substr(start);
+        output_.resize(start);
+        output_ += "\x1b[";
+
+        if (x > cursor_.X)
+        {
+            if (x - cursor_.X > 1) { AppendNumber(x - cursor_.X); }
+            output_ += 'C';
+        }
+        else
+        {
+            AppendNumber(x + 1);
+            output_ += 'G';
+        }
+
+        if (output_.size() - start > absolute.size())
+        {
+            output_.resize(start);
+            output_ += absolute;
+        }
+    }
+
+    cursor_ = {x, y};
+}
+
+void VTConsoleBackend::SetColor(WORD color)
+{
+    const int fg = color & 0x0F;
+    const int bg = (color >> 4) & 0x0F;
+    if (fg == fg_ && bg == bg_)
+        return;
+
+    // emit changed parameters only, intensity uses bright colors.
+    output_ += "\x1b[";
+    if (fg != fg_)
+    {
+        AppendNumber(((fg & 0x8) ? 90 : 30) + ToAnsiColor(fg));
+        if (bg != bg_) { output_ += ';'; }
+    }
+    if (bg != bg_)
+    {
+        AppendNumber(((bg & 0x8) ? 100 : 40) + ToAnsiColor(bg));
+    }
+    output_ += 'm';
+
+    fg_ = fg;
+    bg_ = bg;
+}
+
+void VTConsoleBackend::AppendNumber(int number)
+{
+    char digits[12];
+    int num_digits = 0;
+    do
+    {
+        digits[num_digits++] = static_cast<char>('0' + number % 10);
+        number /= 10;
+    } while (number > 0);
+
+    while (num_digits > 0)
+    {
+        output_ += digits[--num_digits];
+    }
+}
+
+void VTConsoleBackend::ReadInput(int timeout)
+{
+    pollfd fds = {STDIN_FILENO, POLLIN, 0};
+    if (::poll(&fds, 1, timeout) <= 0)
+        return;
+
+    char buffer[256];
+    const ssize_t size = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+    if (size <= 0)
+        return;
+
+    input_.append(buffer, static_cast<std::size_t>(size));
+    ParseInput();
+}
+
+void VTConsoleBackend::ParseInput()
+{
+    std::size_t pos = 0;
+    while (pos < input_.size())
+    {
+        const unsigned char byte = static_cast<unsigned char>(input_[pos]);
+
+        if (byte == 0x1B)
+        {
+            const std::size_t next = ParseEscape(pos);
+            if (next == pos) { break; }
+            pos = next;
+            continue;
+        }
+
+        if (byte == ' ')
+            PushKey(VK_SPACE, L' ');
+        else if (byte == '\r' || byte == '\n')
+            PushKey(VK_RETURN, L'\r');
+        else if (byte == '\t')
+            PushKey(VK_TAB, L'\t');
+        else if (byte == 0x08 || byte == 0x7F)
+            PushKey(VK_BACK, L'\b');
+        else if (byte < 0x20)
+            PushKey(VK_CONTROL, 0);  // ctrl + letter, the closest thing to ctrl key.
+        else if (byte >= 'a' && byte <= 'z')
+            PushKey(static_cast<WORD>(byte - 'a' + 'A'), static_cast<wchar_t>(byte));
+        else if (byte < 0x80)
+            PushKey(static_cast<WORD>(byte), static_cast<wchar_t>(byte));
+
+        pos += 1;
+    }
+
+    input_.erase(0, pos);
+}
+
+std::size_t VTConsoleBackend::ParseEscape(std::size_t pos)
+{
+    // an escape sequence arrives at once, so a lone escape is the escape key.
+    const char intro = (pos + 1 < input_.size() ? input_[pos + 1] : 0);
+    if (intro != '[' && intro != 'O')
+    {
+        PushKey(VK_ESCAPE, 0x1B);
+        return pos + 1;
+    }
+
+    // find the final byte of control sequence.
+    std::size_t end = pos + 2;
+    while (end < input_.size() && (input_[end] < 0x40 || input_[end] > 0x7E))
+    {
+        end += 1;
+    }
+    if (end >= input_.size())
+    {
+        // wait for the rest of a split sequence.
+        return pos;
+    }
+
+    const char final_byte = input_[end];
+    switch (final_byte)
+    {
+        case 'A': PushKey(VK_UP,    0); break;
+        case 'B': PushKey(VK_DOWN,  0); break;
+        case 'C': PushKey(VK_RIGHT, 0); break;
+        case 'D': PushKey(VK_LEFT,  0); break;
+
+        case 'M':
+        case 'm':
+        {
+            // SGR mouse report: ESC [ < button ; x ; y M/m, 1-based position.
+            int button = 0, x = 0, y = 0;
+            if (input_[pos + 2] == '<' &&
+                std::sscanf(input_.c_str() + pos + 3, "%d;%d;%d", &button, &x, &y) == 3)
+            {
+                const bool moved = (button & 0x20) != 0;
+                const bool left_pressed = final_byte == 'M' && (button & 0x43) == 0;
+                events_.push_back(MakeMouseEvent(
+                    static_cast<SHORT>(x - 1), static_cast<SHORT>(y - 1),
+                    left_pressed ? FROM_LEFT_1ST_BUTTON_PRESSED : 0,
+                    moved ? MOUSE_MOVED : 0));
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return end + 1;
+}
+
+void VTConsoleBackend::PushKey(WORD key, wchar_t ch)
+{
+    // terminals report key presses only, release the key immediately.
+    events_.push_back(MakeKeyEvent(key, ch, true));
+    events_.push_back(MakeKeyEvent(key, ch, false));
+}
+
+//==============================================================================
+// ConsoleBackend - Interface
+//==============================================================================
+
+std::unique_ptr<ConsoleBackend> ConsoleBackend::MakeVTBackend()
+{
+    return std::make_unique<VTConsoleBackend>();
+}
+
+}
+
+#endif
\ No newline at end of file
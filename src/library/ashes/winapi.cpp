@@ -1,34 +1,92 @@
 ﻿#include "winapi.h"
 #include <cwchar>
-#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <map>
+#include <mutex>
+#include <unistd.h>
+#include "mappedfile.h"
+#endif
 
 namespace ashes { namespace win {
 
-std::string LoadModuleResource(const char* name, const char* type)
+#ifdef _WIN32
+
+std::pair<const void*, std::size_t> LockModuleResource(const char* name, const char* type)
 {
     HRSRC handle = ::FindResourceA(NULL, name, type);
-    assert(handle != NULL);
+    DWORD size = (handle != NULL ? ::SizeofResource(NULL, handle) : 0);
+    HGLOBAL data = (size > 0 ? ::LoadResource(NULL, handle) : NULL);
+    LPVOID locked_data = (data != NULL ? ::LockResource(data) : nullptr);
+    if (locked_data == nullptr)
+        return {nullptr, 0};
 
-    DWORD size = ::SizeofResource(NULL, handle);
-    assert(size > 0);
+    return {locked_data, size};
+}
 
-    HGLOBAL data = ::LoadResource(NULL, handle);
-    assert(data != NULL);
+bool IsAtLocaleZN()
+{
+    wchar_t name[LOCALE_NAME_MAX_LENGTH];
+    ::GetUserDefaultLocaleName(name, static_cast<int>(std::size(name)));
+    return ::_wcsnicmp(name, L"ZH", 2) == 0;
+}
 
-    LPVOID locked_data = ::LockResource(data);
-    assert(locked_data != nullptr);
+#else
 
-    std::string str(reinterpret_cast<char*>(locked_data), size);
-    ::FreeResource(data);
+namespace {
+
+// directory of the executable, or the current one if it's unknown.
+std::string GetModuleDirectory()
+{
+    char path[4096];
+    const ssize_t len = ::readlink("/proc/self/exe", path, sizeof(path));
+    if (len <= 0 || len == static_cast<ssize_t>(sizeof(path)))
+        return ".";
+
+    const std::string exe_path(path, len);
+    return exe_path.substr(0, exe_path.rfind('/'));
+}
 
-    return str;
+}
+
+std::pair<const void*, std::size_t> LockModuleResource(const char* name, const char* /*type*/)
+{
+    // files are mapped read-only once and kept until exit, like resources of
+    // a module, a file which can't be mapped is tried again next time.
+    static std::map<std::string, MappedFile> files;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+
+    MappedFile& file = files[name];
+    if (!file.IsOpen() && !file.OpenReadOnly(GetModuleDirectory() + "/res/" + name))
+        return {nullptr, 0};
+
+    return {file.GetData(), file.GetSize()};
 }
 
 bool IsAtLocaleZN()
 {
-    wchar_t name[LOCALE_NAME_MAX_LENGTH];
-    ::GetUserDefaultLocaleName(name, static_cast<int>(std::size(name)));
-    return ::_wcsnicmp(name, L"ZH", 2) == 0;
+    // locale names look like "zh_CN.UTF-8" on posix platforms.
+    const char* names[] = {std::getenv("LC_ALL"), std::getenv("LANG")};
+    for (const char* name : names)
+    {
+        if (name != nullptr && *name != '\0')
+            return (name[0] == 'z' || name[0] == 'Z') && (name[1] == 'h' || name[1] == 'H');
+    }
+    return false;
+}
+
+#endif
+
+std::string LoadModuleResource(const char* name, const char* type)
+{
+    const auto resource = LockModuleResource(name, type);
+    if (resource.first == nullptr)
+        return {};
+
+    return std::string(static_cast<const char*>(resource.first), resource.second);
 }
 
 std::wstring A2W(const std::string& str, UINT code_page)
@@ -41,6 +99,8 @@ std::string W2A(const std::wstring& wstr, UINT code_page)
     return W2A(wstr.data(), static_cast<int>(wstr.size()), code_page);
 }
 
+#ifdef _WIN32
+
 std::wstring A2W(const char* str, int len, UINT code_page)
 {
     len = (len < 0 ? static_cast<int>(std::strlen(str)) : len);
@@ -67,8 +127,75 @@ std::string W2A(const wchar_t* wstr, int wlen, UINT code_page)
     len = ::WideCharToMultiByte(code_page, 0, wstr, wlen, &str[0], len, 0, 0);
     if (len != static_cast<int>(str.size()))
         return {};
-    
+
     return str;
 }
 
+#else
+
+// code page is always UTF-8 on posix platforms, a wchar_t holds a code point.
+std::wstring A2W(const char* str, int len, UINT /*code_page*/)
+{
+    len = (len < 0 ? static_cast<int>(std::strlen(str)) : len);
+    std::wstring wstr;
+    wstr.reserve(len);
+
+    for (int i = 0; i < len;)
+    {
+        const unsigned char lead = static_cast<unsigned char>(str[i]);
+        const int num_trails = (lead < 0x80 ? 0 : lead < 0xE0 ? 1 : lead < 0xF0 ? 2 : 3);
+        if (i + num_trails >= len)
+            return {};
+
+        unsigned int code = (num_trails == 0 ? lead : lead & (0x3F >> num_trails));
+        for (int k = 1; k <= num_trails; ++k)
+        {
+            code = (code << 6) | (static_cast<unsigned char>(str[i + k]) & 0x3F);
+        }
+
+        wstr += static_cast<wchar_t>(code);
+        i += num_trails + 1;
+    }
+
+    return wstr;
+}
+
+std::string W2A(const wchar_t* wstr, int wlen, UINT /*code_page*/)
+{
+    wlen = (wlen < 0 ? static_cast<int>(std::wcslen(wstr)) : wlen);
+    std::string str;
+    str.reserve(wlen);
+
+    for (int i = 0; i < wlen; ++i)
+    {
+        const unsigned int code = static_cast<unsigned int>(wstr[i]);
+        if (code < 0x80)
+        {
+            str += static_cast<char>(code);
+        }
+        else if (code < 0x800)
+        {
+            str += static_cast<char>(0xC0 | (code >> 6));
+            str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            str += static_cast<char>(0xE0 | (code >> 12));
+            str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            str += static_cast<char>(0xF0 | (code >> 18));
+            str += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            str += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            str += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    return str;
+}
+
+#endif
+
 }}
\ No newline at end of file
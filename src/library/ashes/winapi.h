@@ -2,12 +2,20 @@
 #define ASHES_WINAPI_H
 
 #include <string>
-#include <windows.h>
+#include <cstddef>
+#include <utility>
+#include "platform.h"
 
 namespace ashes { namespace win {
 
+// on other platforms, a resource is the file of the name in directory "res"
+// beside the executable, and the type is ignored.
 std::string LoadModuleResource(const char* name, const char* type);
 
+// data of a resource stays mapped with the module, it need not be freed.
+// {nullptr, 0} or an empty string is returned if the resource is missing.
+std::pair<const void*, std::size_t> LockModuleResource(const char* name, const char* type);
+
 bool IsAtLocaleZN();
 
 std::wstring A2W(const std::string& str, UINT code_page);
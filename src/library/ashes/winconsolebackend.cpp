@@ -0,0 +1,235 @@
+﻿#ifdef _WIN32
+
+#include "consolebackend.h"
+#include <cassert>
+#include <algorithm>
+
+namespace ashes {
+
+namespace {
+
+CONSOLE_SCREEN_BUFFER_INFOEX GetConsoleBufferInfoEX(HANDLE console)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX info = {sizeof(info)};
+    BOOL success = ::GetConsoleScreenBufferInfoEx(console, &info);
+    assert(success);
+    return info;
+}
+
+bool ResizeConsoleBuffer(HANDLE console, Coord size)
+{
+    CONSOLE_SCREEN_BUFFER_INFOEX info = GetConsoleBufferInfoEX(console);
+    info.dwSize = size;
+    info.dwMaximumWindowSize = size;
+    info.srWindow = Rect({0, 0}, size);
+    info.srWindow.Bottom += 1;
+    return ::SetConsoleScreenBufferInfoEx(console, &info);
+}
+
+}
+
+//==============================================================================
+// ConsoleBackend - Win32
+//==============================================================================
+
+class Win32ConsoleBackend : public ConsoleBackend
+{
+public:
+
+    Win32ConsoleBackend();
+
+    Coord Size() const override;
+    bool Resize(const Coord& size) override;
+    void Center() override;
+    void SetUnresizable() override;
+
+    void SetCodePage(UINT code_page) override;
+    void SetFont(const std::wstring& face_name, const Coord& size, UINT weight) override;
+    void SetTitle(const String& title) override;
+    void SetUneditable() override;
+
+    int CountEvent() override;
+    void WaitEvent(INPUT_RECORD& event) override;
+    bool WaitEventFor(time::Msecs timeout) override;
+
+    SHORT MaxUnchangedGap() const override;
+    void ReadOutput(CHAR_INFO* cells, const Coord& size) override;
+    void WriteOutput(const CHAR_INFO* cells, const Coord& size, const Rect& region) override;
+    std::size_t FlushOutput() override;
+
+private:
+
+    HANDLE      input_ = INVALID_HANDLE_VALUE;   // the console input buffer
+    HANDLE      output_ = INVALID_HANDLE_VALUE;  // the console window output buffer
+    std::size_t num_written_bytes_ = 0;          // bytes written since last flush
+};
+
+Win32ConsoleBackend::Win32ConsoleBackend()
+{
+    input_ = ::GetStdHandle(STD_INPUT_HANDLE);
+    output_ = ::GetStdHandle(STD_OUTPUT_HANDLE);
+
+    assert(input_ != INVALID_HANDLE_VALUE);
+    assert(output_ != INVALID_HANDLE_VALUE);
+}
+
+Coord Win32ConsoleBackend::Size() const
+{
+    return GetConsoleBufferInfoEX(output_).dwSize;
+}
+
+bool Win32ConsoleBackend::Resize(const Coord& size)
+{
+    return ResizeConsoleBuffer(output_, size);
+}
+
+void Win32ConsoleBackend::Center()
+{
+    BOOL success = TRUE;
+    HWND window = ::GetConsoleWindow();
+    assert(window != NULL);
+
+    // window size
+    RECT window_rect;
+    success = ::GetWindowRect(window, &window_rect);
+    assert(success);
+    LONG width = window_rect.right - window_rect.left;
+    LONG height = window_rect.bottom - window_rect.top;
+
+    // work area size
+    RECT work_area;
+    success = ::SystemParametersInfo(SPI_GETWORKAREA, 0, &work_area, 0);
+    assert(success);
+    LONG work_area_width = work_area.right - work_area.left;
+    LONG work_area_height = work_area.bottom - work_area.top;
+
+    // center
+    LONG left = work_area.left + (work_area_width  - width)  / 2;
+    LONG top  = work_area.top  + (work_area_height - height) / 2;
+    success = ::SetWindowPos(window, HWND_TOPMOST, left, top, 0, 0, SWP_NOSIZE);
+    assert(success);
+}
+
+void Win32ConsoleBackend::SetUnresizable()
+{
+    HWND window = ::GetConsoleWindow();
+    assert(window != NULL);
+    LONG style = ::GetWindowLong(window, GWL_STYLE);
+    style &= ~(WS_MAXIMIZEBOX | WS_SIZEBOX);
+    ::SetWindowLong(window, GWL_STYLE, style);
+}
+
+void Win32ConsoleBackend::SetCodePage(UINT code_page)
+{
+    BOOL success = ::SetConsoleOutputCP(code_page);
+    assert(success);
+}
+
+void Win32ConsoleBackend::SetFont(
+    const std::wstring& face_name,
+    const Coord& size,
+    UINT weight)
+{
+    CONSOLE_FONT_INFOEX info = {0};
+    info.cbSize = sizeof(info);
+    info.FontWeight = weight;
+    info.dwFontSize = size;
+    ::wcscpy_s(info.FaceName, face_name.c_str());
+    BOOL success = ::SetCurrentConsoleFontEx(output_, FALSE, &info);
+    assert(success);
+}
+
+void Win32ConsoleBackend::SetTitle(const String& title)
+{
+    BOOL success = ::SetConsoleTitle(title.c_str());
+    assert(success);
+}
+
+void Win32ConsoleBackend::SetUneditable()
+{
+    BOOL success = TRUE;
+
+    // disable quick edit mode.
+    DWORD mode = 0;
+    success = ::GetConsoleMode(input_, &mode);
+    assert(success);
+    success = ::SetConsoleMode(input_, mode & ~ENABLE_QUICK_EDIT_MODE);
+    assert(success);
+
+    // hide console cursor.
+    CONSOLE_CURSOR_INFO cursor_info = {1, FALSE};
+    success = ::SetConsoleCursorInfo(output_, &cursor_info);
+    assert(success);
+}
+
+int Win32ConsoleBackend::CountEvent()
+{
+    DWORD number = 0;
+    BOOL success = ::GetNumberOfConsoleInputEvents(input_, &number);
+    assert(success);
+    return static_cast<int>(number);
+}
+
+void Win32ConsoleBackend::WaitEvent(INPUT_RECORD& event)
+{
+    DWORD readed_number = 0;
+    ::ReadConsoleInput(input_, &event, 1, &readed_number);
+    assert(readed_number == 1);
+}
+
+bool Win32ConsoleBackend::WaitEventFor(time::Msecs timeout)
+{
+    const DWORD msecs = timeout >= time::Msecs(INFINITE) ? INFINITE
+        : static_cast<DWORD>((std::max)(timeout.count(), time::Msecs::rep(0)));
+    return ::WaitForSingleObject(input_, msecs) == WAIT_OBJECT_0;
+}
+
+SHORT Win32ConsoleBackend::MaxUnchangedGap() const
+{
+    // a write call costs much more than a few cells.
+    return 8;
+}
+
+void Win32ConsoleBackend::ReadOutput(CHAR_INFO* cells, const Coord& size)
+{
+    CHAR_INFO blank = {};
+    blank.Char.UnicodeChar = L' ';
+    blank.Attributes = GetConsoleBufferInfoEX(output_).wAttributes & 0xFF;
+    std::fill_n(cells, size.X * size.Y, blank);
+
+    // read char infos of whole window, keep blank if it's unreadable.
+    Rect read_region = {{0, 0}, size};
+    ::ReadConsoleOutputW(output_, cells, size, {0, 0}, &read_region);
+}
+
+void Win32ConsoleBackend::WriteOutput(
+    const CHAR_INFO* cells,
+    const Coord& size,
+    const Rect& region)
+{
+    Rect write_region = region;
+    BOOL success = ::WriteConsoleOutputW(output_, cells, size,
+        region.TopLeft(), &write_region);
+    assert(success);
+    num_written_bytes_ += region.Width() * region.Height() * sizeof(CHAR_INFO);
+}
+
+std::size_t Win32ConsoleBackend::FlushOutput()
+{
+    std::size_t num_bytes = num_written_bytes_;
+    num_written_bytes_ = 0;
+    return num_bytes;
+}
+
+//==============================================================================
+// ConsoleBackend - Interface
+//==============================================================================
+
+std::unique_ptr<ConsoleBackend> ConsoleBackend::MakeWin32Backend()
+{
+    return std::make_unique<Win32ConsoleBackend>();
+}
+
+}
+
+#endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 ﻿#include "gameapp.h"
 #include <chrono>
+#include <climits>
 #include <functional>
 #include "ashes/random.h"
 #include "ashes/console.h"
@@ -45,6 +46,12 @@ const ashes::Rect GameApp::kScoreBarRect = {24, 10, 35, 10};
 const ashes::Rect GameApp::kDifficultyBarRect = {24, 13, 35, 13};
 
 GameApp::GameApp()
+    : GameApp(ashes::time::GetRealClock())
+{
+}
+
+GameApp::GameApp(ashes::time::Clock& clock)
+    : SimpleConsoleApp(clock), game_(clock)
 {
 }
 
@@ -73,7 +80,21 @@ void GameApp::OnInit()
     // setup events. 
     game_.OnPolyominoTransformed.Bind(this, &GameApp::OnPolyominoTransformed);
     game_.OnPolyominoPlaced.Bind(this, &GameApp::OnPolyominoPlaced);
-    GetTimerManager().NewTimer2(std::bind(&GameCore::TickGame, &game_), 5ms, true);
+    tick_game_timer_ = GetTimerManager().NewTimer2(
+        std::bind(&GameApp::OnTickGame, this), game_.GetTickTimeout(), true);
+}
+
+void GameApp::OnBenchmarkFrame()
+{
+    // polyominos fall without control, a descent and a full draw per frame.
+    if (game_.IsGameOVer())
+    {
+        game_.StartGame();
+    }
+
+    GetClock().Sleep(game_.GetTickTimeout());
+    game_.TickGame();
+    DrawGame();
 }
 
 void GameApp::DealKeyEvent(WORD key, bool pressed)
@@ -97,6 +118,7 @@ void GameApp::DealKeyEvent(WORD key, bool pressed)
             {
                 game_.StartGame();
                 DrawGame();
+                ScheduleTickGame();
             }
         }
     }
@@ -200,6 +222,17 @@ void GameApp::DrawGameOverTip()
         0x0F, &border);
 }
 
+void GameApp::OnTickGame()
+{
+    game_.TickGame();
+    ScheduleTickGame();
+}
+
+void GameApp::ScheduleTickGame()
+{
+    GetTimerManager().SetTimer(tick_game_timer_, game_.GetTickTimeout(), true);
+}
+
 void GameApp::OnPolyominoTransformed(const Polyomino& original_polyomino)
 {
     ashes::Rect bounding1 = original_polyomino.Bounding();
@@ -5,6 +5,7 @@
 #include "ashes/rect.h"
 #include "ashes/coord.h"
 #include "ashes/graph.h"
+#include "ashes/time.h"
 #include "ashes/consoleapp.h"
 #include "gamecore.h"
 
@@ -13,11 +14,13 @@ class GameApp : public ashes::SimpleConsoleApp
 public:
 
     GameApp();
+    explicit GameApp(ashes::time::Clock& clock);
     ~GameApp();
 
 protected:
 
     void OnInit() override;
+    void OnBenchmarkFrame() override;
     void DealKeyEvent(WORD key, bool pressed) override;
 
 private:
@@ -52,12 +55,15 @@ private:
     // Event handling
     //==========================================================================
 
+    void OnTickGame();
+    void ScheduleTickGame();
     void OnPolyominoTransformed(const Polyomino& original_polyomino);
     void OnPolyominoPlaced(int num_completed_lines);
 
 private:
     
-    GameCore game_;
+    GameCore           game_;
+    ashes::TimerHandle tick_game_timer_ = nullptr;
 };
 
 #endif
\ No newline at end of file
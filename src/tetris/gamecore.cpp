@@ -10,6 +10,12 @@ const std::vector<ashes::time::Msecs> GameCore::kDescendCooldowns
 const std::vector<int> GameCore::kScoreCoefficients = {0, 100, 200, 400, 800};
 
 GameCore::GameCore()
+    : GameCore(ashes::time::GetRealClock())
+{
+}
+
+GameCore::GameCore(ashes::time::Clock& clock)
+    : clock_(clock)
 {
 }
 
@@ -122,7 +128,7 @@ void GameCore::TickGame()
 {
     if (!game_over_)
     {
-        ashes::time::TimePoint now = ashes::time::Now();
+        ashes::time::TimePoint now = clock_.Now();
 
         if (now >= descend_timing_)
         {
@@ -132,6 +138,15 @@ void GameCore::TickGame()
     }
 }
 
+ashes::time::Msecs GameCore::GetTickTimeout() const
+{
+    // TickGame does nothing until the polyomino can descend.
+    if (game_over_)
+        return ashes::time::Msecs::max();
+
+    return ashes::time::MsecsUntil(descend_timing_, clock_.Now());
+}
+
 Polyomino GameCore::SpawnNewPolyomino()
 {
     Polyomino polyomino;
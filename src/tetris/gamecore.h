@@ -13,6 +13,7 @@ class GameCore
 public:
 
     GameCore();
+    explicit GameCore(ashes::time::Clock& clock);
     GameCore(const GameCore&) = delete;
     ~GameCore();
     GameCore& operator = (const GameCore&) = delete;
@@ -31,6 +32,7 @@ public:
 
     void StartGame();
     void TickGame();
+    ashes::time::Msecs GetTickTimeout() const;
 
     ashes::EventDispatcher<void(const Polyomino&)> OnPolyominoTransformed;
     ashes::EventDispatcher<void(int)>              OnPolyominoPlaced;
@@ -46,6 +48,7 @@ private:
 
 private:
 
+    ashes::time::Clock&    clock_;
     bool                   game_over_ = true;
     PlayingField           field_;
     Polyomino              polyomino_;
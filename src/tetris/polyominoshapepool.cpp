@@ -1,7 +1,9 @@
 ﻿#include "polyominoshapepool.h"
 #include <cctype>
 #include <cassert>
+#include <cstdlib>
 #include <sstream>
+#include <iostream>
 #include <iterator>
 #include <algorithm>
 #include "ashes/random.h"
@@ -56,9 +58,18 @@ PolyominoShapePool::~PolyominoShapePool()
 
 PolyominoShapePool::ShapeBook PolyominoShapePool::LoadShapeBookFromResource()
 {
+#ifdef _WIN32
     const char* name = MAKEINTRESOURCEA(IDR_TXT_SHAPEBOOK);
+#else
+    const char* name = "shapebook.txt";
+#endif
     const std::string resource = ashes::win::LoadModuleResource(name, "TXT");
-    assert(!resource.empty());
+    if (resource.empty())
+    {
+        // no shape to spawn, the game can't go on.
+        std::cerr << "can't load the shape book (res/shapebook.txt)\n";
+        std::abort();
+    }
 
     std::stringstream sstream(resource);
     std::vector<std::string> lines;
@@ -66,7 +77,8 @@ PolyominoShapePool::ShapeBook PolyominoShapePool::LoadShapeBookFromResource()
     for (std::string line; std::getline(sstream, line); )
     {
         // remove trailing whitespace.
-        auto iter = std::find_if_not(line.rbegin(), line.rend(), std::isspace);
+        auto iter = std::find_if_not(line.rbegin(), line.rend(),
+            [](unsigned char ch) { return std::isspace(ch) != 0; });
         line.erase(iter.base(), line.end());
         lines.push_back(line);
     }